@@ -1,6 +1,9 @@
 #include "device_memory_impl.h"
 
 #include "axis_modsum.h"
+#include "mod_arith.h"
+#include "modop_kernels.h"
+#include "strided_loop.h"
 
 #include <stdexcept>
 #include <algorithm>
@@ -9,6 +12,55 @@
 
 namespace lattica_hw_api {
 
+// ---- axis_modsum ----
+//
+// Terms in [0, p) are summed exactly in a double-width word and reduced once per output;
+// such a sum cannot wrap for any realistic axis length (2^bits(T) terms). An output with a
+// term outside [0, p), or a modulus below 1, is recomputed with the reference chain
+// sum = (sum + x) % p so its result is unchanged.
+
+namespace {
+
+template <typename T>
+using AxisSum = typename ShoupTypes<T>::dword;
+
+constexpr int64_t axis_sum_block = 64;
+
+// Adds the terms r in [r_begin, r_end) of `count` outputs to sums[j] and clears
+// in_range[j] if one of them is outside [0, p). Output j reads a[j * sa + r * axis_stride]
+// and p[j * sq]. Outputs are taken in blocks, the axis walked once per block, so
+// consecutive outputs read consecutive elements.
+template <typename T>
+void accumulate_axis_terms(const T* a, int64_t sa, int64_t axis_stride, const T* p, int64_t sq,
+                           int64_t count, int64_t r_begin, int64_t r_end,
+                           AxisSum<T>* sums, unsigned char* in_range) {
+    using word = ShoupWord<T>;
+    for (int64_t j0 = 0; j0 < count; j0 += axis_sum_block) {
+        const int64_t n = std::min(axis_sum_block, count - j0);
+        for (int64_t r = r_begin; r < r_end; ++r) {
+            const T* src = a + j0 * sa + r * axis_stride;
+            for (int64_t j = 0; j < n; ++j) {
+                const word x = static_cast<word>(src[j * sa]);
+                sums[j0 + j] += x;
+                in_range[j0 + j] &= x < static_cast<word>(p[(j0 + j) * sq]);
+            }
+        }
+    }
+}
+
+template <typename T>
+T finish_axis_sum(AxisSum<T> sum, bool in_range, const T* src, int64_t axis_stride,
+                  int64_t axis_size, T mod) {
+    if (in_range && mod >= 1) return static_cast<T>(sum % static_cast<ShoupWord<T>>(mod));
+    T chained = 0;
+    for (int64_t r = 0; r < axis_size; ++r) {
+        chained = (chained + src[r * axis_stride]) % mod;
+    }
+    return chained;
+}
+
+} // namespace
+
 template <typename T>
 void axis_modsum(
     const std::shared_ptr<DeviceTensor<T>>& a,
@@ -31,50 +83,249 @@ void axis_modsum(
     if (in_shape.back() != k_dim) {
         throw std::invalid_argument("Last dimension of a must match shape of p");
     }
+    result->montgomery = a->montgomery;  // a sum of Montgomery-form terms stays in that form
 
-    int64_t result_numel = 1;
-    for (auto d : result->dims) result_numel *= d;
+    // Iterate over result; `a` is read with the reduced axis taken out of its layout and
+    // walked separately, and p[k] lines up with the last axis.
     const int64_t axis_size = in_shape[axis];
+    const int64_t axis_stride = a->strides[axis];
+    std::vector<int64_t> a_dims = in_shape, a_strides = a->strides;
+    a_dims.erase(a_dims.begin() + axis);
+    a_strides.erase(a_strides.begin() + axis);
+
+    const T* a_ptr = reinterpret_cast<const T*>(a->data.get());
+    const T* p_ptr = reinterpret_cast<const T*>(p->data.get());
+    T* out_ptr = reinterpret_cast<T*>(result->data.get());
+
+    const StridedLoop<3> loop(result->dims, {StridedOperand(result->dims, result->strides),
+                                             StridedOperand(a_dims, a_strides),
+                                             StridedOperand(p->dims, p->strides)});
+    const int64_t outputs = loop.numel();
+    const int64_t threads = omp_get_max_threads();
+    constexpr int64_t grain = 32768;
 
-    // Compute flat-to-multidim strides for result
-    std::vector<int64_t> res_strides(result->dims.size(), 1);
-    for (int64_t i = result->dims.size() - 2; i >= 0; --i) {
-        res_strides[i] = res_strides[i + 1] * result->dims[i + 1];
+    // Enough outputs (or too little work) to keep every thread busy: split the outputs.
+    if (threads == 1 || outputs >= threads * axis_sum_block || axis_size < 2 * threads ||
+        outputs * axis_size < grain) {
+        loop.parallel_run([&](int64_t, const std::array<int64_t, 3>& offset,
+                              const std::array<int64_t, 3>& stride, int64_t count) {
+            AxisSum<T> sums[axis_sum_block];
+            unsigned char in_range[axis_sum_block];
+            for (int64_t j0 = 0; j0 < count; j0 += axis_sum_block) {
+                const int64_t n = std::min(axis_sum_block, count - j0);
+                const T* src = a_ptr + offset[1] + j0 * stride[1];
+                const T* mod = p_ptr + offset[2] + j0 * stride[2];
+                std::fill(sums, sums + n, AxisSum<T>(0));
+                std::fill(in_range, in_range + n, 1);
+                accumulate_axis_terms(src, stride[1], axis_stride, mod, stride[2], n, 0, axis_size,
+                                      sums, in_range);
+                for (int64_t j = 0; j < n; ++j) {
+                    out_ptr[offset[0] + (j0 + j) * stride[0]] =
+                        finish_axis_sum(sums[j], in_range[j], src + j * stride[1], axis_stride,
+                                        axis_size, mod[j * stride[2]]);
+                }
+            }
+        }, grain / std::max<int64_t>(axis_size, 1));
+        return;
     }
 
-    #pragma omp parallel for
-    for (int64_t flat_idx = 0; flat_idx < result_numel; ++flat_idx) {
-        // Convert flat_idx to res_coord
-        std::vector<int64_t> res_coord(result->dims.size());
-        int64_t rem = flat_idx;
-        for (int64_t i = 0; i < (int64_t)res_coord.size(); ++i) {
-            res_coord[i] = rem / res_strides[i];
-            rem %= res_strides[i];
-        }
+    // Few outputs over a long axis: each thread sums a slice of the axis for every output
+    // into its own row of partial sums, and the rows are combined before the reduction.
+    std::vector<AxisSum<T>> partial(threads * outputs, AxisSum<T>(0));
+    std::vector<unsigned char> in_range(threads * outputs, 1);
 
-        // Build input coord with axis inserted
-        std::vector<int64_t> in_coord;
-        in_coord.reserve(ndim);
-        for (int64_t i = 0, j = 0; i < ndim; ++i) {
-            if (i == axis) {
-                in_coord.push_back(0); // placeholder
-            } else {
-                in_coord.push_back(res_coord[j++]);
+    #pragma omp parallel num_threads(threads)
+    {
+        const int64_t t = omp_get_thread_num();
+        const int64_t nt = omp_get_num_threads();
+        AxisSum<T>* sums = partial.data() + t * outputs;
+        unsigned char* ok = in_range.data() + t * outputs;
+        loop.run(0, outputs, [&](int64_t pos, const std::array<int64_t, 3>& offset,
+                                 const std::array<int64_t, 3>& stride, int64_t count) {
+            accumulate_axis_terms(a_ptr + offset[1], stride[1], axis_stride, p_ptr + offset[2],
+                                  stride[2], count, axis_size * t / nt, axis_size * (t + 1) / nt,
+                                  sums + pos, ok + pos);
+        });
+    }
+
+    loop.run(0, outputs, [&](int64_t pos, const std::array<int64_t, 3>& offset,
+                             const std::array<int64_t, 3>& stride, int64_t count) {
+        for (int64_t j = 0; j < count; ++j) {
+            AxisSum<T> sum = 0;
+            bool ok = true;
+            for (int64_t t = 0; t < threads; ++t) {
+                sum += partial[t * outputs + pos + j];
+                ok = ok && in_range[t * outputs + pos + j];
             }
+            out_ptr[offset[0] + j * stride[0]] =
+                finish_axis_sum(sum, ok, a_ptr + offset[1] + j * stride[1], axis_stride, axis_size,
+                                p_ptr[offset[2] + j * stride[2]]);
         }
+    });
+}
 
-        T mod = p->at({in_coord[ndim - 1]});
-        T sum = 0;
-        for (int64_t r = 0; r < axis_size; ++r) {
-            in_coord[axis] = r;
-            sum = (sum + a->at(in_coord)) % mod;
-        }
+// ---- modmul_axis_sum ----
+
+namespace {
 
-        result->at(res_coord) = sum;
+std::vector<int64_t> broadcast_shape(const std::vector<int64_t>& x, const std::vector<int64_t>& y) {
+    std::vector<int64_t> shape(std::max(x.size(), y.size()), 1);
+    for (size_t i = 1; i <= shape.size(); ++i) {
+        const int64_t dx = i <= x.size() ? x[x.size() - i] : 1;
+        const int64_t dy = i <= y.size() ? y[y.size() - i] : 1;
+        if (dx != dy && dx != 1 && dy != 1)
+            throw std::invalid_argument("a and b are not broadcast-compatible.");
+        shape[shape.size() - i] = dx == 1 ? dy : dx;
+    }
+    return shape;
+}
+
+// One operand's layout with the reduced axis (of the ndim-dim broadcast shape) taken out,
+// and its stride along that axis: 0 where the operand is broadcast over it.
+struct ReducedAxisLayout {
+    std::vector<int64_t> dims, strides;
+    int64_t axis_stride = 0;
+};
+
+template <typename T>
+ReducedAxisLayout split_reduced_axis(const DeviceTensor<T>& t, int64_t ndim, int64_t axis) {
+    ReducedAxisLayout layout{t.dims, t.strides, 0};
+    const int64_t local = axis - (ndim - static_cast<int64_t>(t.dims.size()));
+    if (local >= 0) {
+        if (t.dims[local] != 1) layout.axis_stride = t.strides[local];
+        layout.dims.erase(layout.dims.begin() + local);
+        layout.strides.erase(layout.strides.begin() + local);
     }
+    return layout;
+}
 
+// x as a residue in [0, q): the value itself in the common case, else its remainder.
+template <typename T>
+inline ShoupWord<T> to_residue(T x, T q) {
+    if (static_cast<ShoupWord<T>>(x) < static_cast<ShoupWord<T>>(q)) return static_cast<ShoupWord<T>>(x);
+    const T r = x % q;
+    return static_cast<ShoupWord<T>>(r < 0 ? r + q : r);
+}
+
+// (carry * 2^(2 bits) + acc) mod p: the exact sum of one output, `acc` being its
+// double-width total and `carry` the number of times that total wrapped.
+template <typename T>
+ShoupWord<T> reduce_wide_sum(typename ShoupTypes<T>::dword acc, uint64_t carry, ShoupWord<T> p) {
+    using word = ShoupWord<T>;
+    using dword = typename ShoupTypes<T>::dword;
+    constexpr int bits = static_cast<int>(sizeof(word) * 8);
+    const word hi = static_cast<word>(acc >> bits) % p;
+    word r = static_cast<word>(((static_cast<dword>(hi) << bits) | static_cast<word>(acc)) % p);
+    if (carry != 0) {
+        const word w = static_cast<word>(word(0) - p) % p;                // 2^bits mod p
+        const word w2 = static_cast<word>(static_cast<dword>(w) * w % p);  // 2^(2 bits) mod p
+        r = static_cast<word>((static_cast<dword>(carry % p) * w2 + r) % p);
+    }
+    return r;
 }
 
+} // namespace
+
+template <typename T>
+void modmul_axis_sum(
+    const std::shared_ptr<DeviceTensor<T>>& a,
+    const std::shared_ptr<DeviceTensor<T>>& b,
+    const std::shared_ptr<DeviceTensor<T>>& p,
+    std::shared_ptr<DeviceTensor<T>>& result,
+    int64_t axis
+) {
+    using word = ShoupWord<T>;
+    using dword = typename ShoupTypes<T>::dword;
+
+    if (p->dims.size() != 1) {
+        throw std::invalid_argument("p must be a 1D tensor of shape [k]");
+    }
+
+    const std::vector<int64_t> shape = broadcast_shape(a->dims, b->dims);
+    const int64_t ndim = shape.size();
+
+    if (axis < 0 || axis >= ndim - 1) {
+        throw std::invalid_argument("axis must be in range [0, ndim - 2] (can't reduce across last axis)");
+    }
+
+    if (shape.back() != p->dims[0]) {
+        throw std::invalid_argument("Last dimension of a and b must match shape of p");
+    }
+
+    std::vector<int64_t> out_shape = shape;
+    out_shape.erase(out_shape.begin() + axis);
+    if (result->dims != out_shape) {
+        throw std::invalid_argument("result must have the broadcast shape of a and b with axis removed");
+    }
+
+    const T* a_ptr = reinterpret_cast<const T*>(a->data.get());
+    const T* b_ptr = reinterpret_cast<const T*>(b->data.get());
+    T* out_ptr = reinterpret_cast<T*>(result->data.get());
+
+    // p is read through the cached modulus table's dense copy, so the element offset of p
+    // also indexes the Montgomery constant p_inv.
+    const auto table = get_modulus_table<T>(ModopInput<T>::tensor(p));
+    const std::vector<int64_t> table_strides{1};
+    const T* p_ptr = table->p.data();
+
+    // A product of two Montgomery-form operands carries an extra factor R, removed with one
+    // Montgomery reduction of each output.
+    const bool redc = a->montgomery && b->montgomery;
+    for (int64_t t = 0; t < table->k; ++t) {
+        const T q = p_ptr[t];
+        if (q < 1) throw std::invalid_argument("Moduli must be positive");
+        if ((a->montgomery || b->montgomery) && !fits_montgomery(q))
+            throw std::invalid_argument("Montgomery form needs odd moduli below 2^(bits - 2)");
+    }
+    result->montgomery = a->montgomery || b->montgomery;
+
+    // Each run of outputs is processed in blocks: the axis is walked once per block with
+    // one exact double-width accumulator per output, so consecutive outputs read
+    // consecutive elements instead of each output striding along the axis.
+    constexpr int64_t block = 64;
+    const int64_t axis_size = shape[axis];
+    const ReducedAxisLayout a_layout = split_reduced_axis(*a, ndim, axis);
+    const ReducedAxisLayout b_layout = split_reduced_axis(*b, ndim, axis);
+
+    const StridedLoop<4> loop(result->dims, {StridedOperand(result->dims, result->strides),
+                                             StridedOperand(a_layout.dims, a_layout.strides),
+                                             StridedOperand(b_layout.dims, b_layout.strides),
+                                             StridedOperand(p->dims, table_strides)});
+    loop.parallel_run([&](int64_t, const std::array<int64_t, 4>& offset,
+                          const std::array<int64_t, 4>& stride, int64_t count) {
+        const int64_t so = stride[0], sx = stride[1], sy = stride[2], sq = stride[3];
+        dword acc[block];
+        uint64_t carry[block];
+        for (int64_t j0 = 0; j0 < count; j0 += block) {
+            const int64_t n = std::min(block, count - j0);
+            const T* x = a_ptr + offset[1] + j0 * sx;
+            const T* y = b_ptr + offset[2] + j0 * sy;
+            const T* q = p_ptr + offset[3] + j0 * sq;
+            std::fill(acc, acc + n, dword(0));
+            std::fill(carry, carry + n, uint64_t(0));
+
+            for (int64_t r = 0; r < axis_size; ++r) {
+                const T* xr = x + r * a_layout.axis_stride;
+                const T* yr = y + r * b_layout.axis_stride;
+                for (int64_t j = 0; j < n; ++j) {
+                    const T qj = q[j * sq];
+                    const dword prod = static_cast<dword>(to_residue<T>(xr[j * sx], qj)) *
+                                       to_residue<T>(yr[j * sy], qj);
+                    acc[j] += prod;
+                    carry[j] += acc[j] < prod;
+                }
+            }
+
+            T* out = out_ptr + offset[0] + j0 * so;
+            for (int64_t j = 0; j < n; ++j) {
+                const word qj = static_cast<word>(q[j * sq]);
+                word v = reduce_wide_sum<T>(acc[j], carry[j], qj);
+                if (redc) v = montgomery_mul_word<T>(v, 1, qj, table->p_inv[offset[3] + (j0 + j) * sq]);
+                out[j * so] = static_cast<T>(v);
+            }
+        }
+    }, 32768 / std::max<int64_t>(axis_size, 1));
+}
 
 template void axis_modsum<int32_t>(
     const std::shared_ptr<DeviceTensor<int32_t>>& a,
@@ -90,4 +341,20 @@ template void axis_modsum<int64_t>(
     int64_t axis
 );
 
+template void modmul_axis_sum<int32_t>(
+    const std::shared_ptr<DeviceTensor<int32_t>>& a,
+    const std::shared_ptr<DeviceTensor<int32_t>>& b,
+    const std::shared_ptr<DeviceTensor<int32_t>>& p,
+    std::shared_ptr<DeviceTensor<int32_t>>& result,
+    int64_t axis
+);
+
+template void modmul_axis_sum<int64_t>(
+    const std::shared_ptr<DeviceTensor<int64_t>>& a,
+    const std::shared_ptr<DeviceTensor<int64_t>>& b,
+    const std::shared_ptr<DeviceTensor<int64_t>>& p,
+    std::shared_ptr<DeviceTensor<int64_t>>& result,
+    int64_t axis
+);
+
 } // namespace lattica_hw_api
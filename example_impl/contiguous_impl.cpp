@@ -1,5 +1,7 @@
 #include "device_memory_impl.h"
 #include "contiguous.h"
+#include "memory_pool_impl.h"
+#include "strided_loop.h"
 #include <numeric>
 #include <stdexcept>
 #include <omp.h>
@@ -13,31 +15,27 @@ namespace lattica_hw_api {
         int64_t total = std::accumulate(
             tensor->dims.begin(), tensor->dims.end(), int64_t(1), std::multiplies<>());
 
-        std::shared_ptr<void> new_data = std::shared_ptr<void>(
-            operator new(total * sizeof(T)),
-            [](void* ptr) { operator delete(ptr); }
-        );
+        // Not zeroed: the parallel copy below is the first touch of every page, split over
+        // the threads as the kernels split the contiguous result.
+        std::shared_ptr<void> new_data = device_allocate(total * sizeof(T), false);
 
         int64_t ndim = tensor->dims.size();
         T* dst_ptr = reinterpret_cast<T*>(new_data.get());
+        const T* src_ptr = reinterpret_cast<const T*>(tensor->data.get());
 
-        // Compute strides for index-to-coord mapping
-        std::vector<int64_t> shape = tensor->dims;
-        std::vector<int64_t> flat_strides(ndim, 1);
+        std::vector<int64_t> dst_strides(ndim, 1);
         for (int64_t i = ndim - 2; i >= 0; --i) {
-            flat_strides[i] = flat_strides[i + 1] * shape[i + 1];
+            dst_strides[i] = dst_strides[i + 1] * tensor->dims[i + 1];
         }
 
-        #pragma omp parallel for
-        for (int64_t idx = 0; idx < total; ++idx) {
-            std::vector<int64_t> coord(ndim);
-            int64_t remaining = idx;
-            for (int64_t d = 0; d < ndim; ++d) {
-                coord[d] = remaining / flat_strides[d];
-                remaining %= flat_strides[d];
-            }
-            dst_ptr[idx] = tensor->at(coord);
-        }
+        const StridedLoop<2> loop(tensor->dims, {StridedOperand(tensor->dims, dst_strides),
+                                                 StridedOperand(tensor->dims, tensor->strides)});
+        loop.parallel_run([&](int64_t, const std::array<int64_t, 2>& offset,
+                              const std::array<int64_t, 2>& stride, int64_t count) {
+            T* dst = dst_ptr + offset[0];
+            const T* src = src_ptr + offset[1];
+            for (int64_t j = 0; j < count; ++j) dst[j * stride[0]] = src[j * stride[1]];
+        });
 
         // Update tensor
         tensor->data = new_data;
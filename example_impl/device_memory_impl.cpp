@@ -1,4 +1,7 @@
 #include "device_memory_impl.h"
+#include "memory_plan_impl.h"
+#include "memory_pool_impl.h"
+#include <algorithm>
 #include <iostream>
 #include <numeric>
 #include <cstring>
@@ -11,21 +14,36 @@ template struct DeviceTensor<int32_t>;
 template struct DeviceTensor<int64_t>;
 template struct DeviceTensor<double>;
 
+namespace {
+
+// Bytes from the first element to one past the last one (0 for an empty tensor).
 template <typename T>
-DeviceTensor<T>::DeviceTensor(const std::vector<int64_t>& dims,
-                 const std::vector<int64_t>& strides,
-                 const void* src_data) : dims(dims), strides(strides)
-{
+int64_t span_bytes(const std::vector<int64_t>& dims, const std::vector<int64_t>& strides) {
+    if (std::find(dims.begin(), dims.end(), 0) != dims.end()) return 0;
     int64_t total_bytes = 1;
     for (size_t i = 0; i < dims.size(); ++i) {
         total_bytes += (dims[i] - 1) * strides[i];
     }
-    total_bytes *= sizeof(T);
+    return total_bytes * sizeof(T);
+}
 
-    void* buffer = malloc(total_bytes);
-    if (!buffer) throw std::bad_alloc();
-    std::memcpy(buffer, src_data, total_bytes);
-    data.reset(buffer, free);
+} // namespace
+
+template <typename T>
+DeviceTensor<T>::DeviceTensor(const std::vector<int64_t>& dims,
+                 const std::vector<int64_t>& strides,
+                 const void* src_data) : dims(dims), strides(strides)
+{
+    const int64_t total_bytes = span_bytes<T>(dims, strides);
+    data = lattica_hw_api::device_allocate(total_bytes, false);
+    lattica_hw_api::touch_partitioned(data.get(), src_data, total_bytes);
+}
+
+template <typename T>
+DeviceTensor<T>::DeviceTensor(const std::vector<int64_t>& dims,
+                 const std::vector<int64_t>& strides,
+                 std::shared_ptr<void> buffer) : dims(dims), strides(strides), data(std::move(buffer))
+{
 }
 
 template <typename T>
@@ -160,7 +178,20 @@ void DeviceTensor<T>::print_metadata() const {
     for (auto d : dims) std::cout << d << " ";
     std::cout << "]  Strides: [";
     for (auto s : strides) std::cout << s << " ";
-    std::cout << "]\n\n";
+    std::cout << "]";
+    if (montgomery) std::cout << "  (Montgomery form)";
+
+    const auto address = reinterpret_cast<uintptr_t>(data.get());
+    std::cout << "  Storage: ";
+    if (const auto* pool = std::get_deleter<lattica_hw_api::PoolDeleter>(data))
+        std::cout << "pool, " << lattica_hw_api::page_backing_name(pool->backing);
+    else
+        std::cout << "external";
+    if (address % lattica_hw_api::memory_pool_alignment == 0)
+        std::cout << ", " << lattica_hw_api::memory_pool_alignment << "-byte aligned";
+    const int node = lattica_hw_api::buffer_numa_node(data.get(), span_bytes<T>(dims, strides));
+    if (node >= 0) std::cout << ", NUMA node " << node;
+    std::cout << "\n\n";
 }
 
 namespace lattica_hw_api {
@@ -168,30 +199,49 @@ namespace lattica_hw_api {
 template <typename T>
 std::shared_ptr<DeviceTensor<T>> allocate_on_hardware(const std::vector<int64_t>& dims) {
     int64_t total_elems = std::accumulate(dims.begin(), dims.end(), int64_t(1), std::multiplies<int64_t>());
-    void* buffer = calloc(total_elems, sizeof(T));
     std::vector<int64_t> strides(dims.size());
     int64_t stride = 1;
     for (int i = dims.size() - 1; i >= 0; --i) {
         strides[i] = stride;
         stride *= dims[i];
     }
-    return std::make_shared<DeviceTensor<T>>(dims, strides, buffer);
+    const size_t bytes = total_elems * sizeof(T);
+    std::shared_ptr<void> buffer = planned_allocate(bytes);
+    if (!buffer) buffer = device_allocate(bytes, true);
+    return std::make_shared<DeviceTensor<T>>(dims, strides, std::move(buffer));
 }
 
 template <typename T>
-std::shared_ptr<DeviceTensor<T>> host_to_device(const torch::Tensor& tensor) {
+std::shared_ptr<DeviceTensor<T>> host_to_device(const torch::Tensor& tensor, bool zero_copy) {
     if (tensor.scalar_type() != torch::CppTypeToScalarType<T>()) {
         throw std::runtime_error("Tensor dtype does not match template parameter T.");
     }
 
     std::vector<int64_t> dims(tensor.sizes().begin(), tensor.sizes().end());
     std::vector<int64_t> strides(tensor.strides().begin(), tensor.strides().end());
+    if (zero_copy) {
+        if (!tensor.device().is_cpu())
+            throw std::invalid_argument("zero_copy host_to_device needs a CPU tensor.");
+        // The deleter holds a reference to the tensor, keeping its storage alive.
+        std::shared_ptr<void> buffer(tensor.data_ptr(), [tensor](void*) {});
+        return std::make_shared<DeviceTensor<T>>(dims, strides, std::move(buffer));
+    }
     return std::make_shared<DeviceTensor<T>>(dims, strides, tensor.data_ptr());
 }
 
 template <typename T>
-torch::Tensor device_to_host(const std::shared_ptr<DeviceTensor<T>>& memory) {
+torch::Tensor device_to_host(const std::shared_ptr<DeviceTensor<T>>& memory, bool view) {
     auto options = torch::TensorOptions().dtype(torch::CppTypeToScalarType<T>());
+    if (view) {
+        // The deleter holds a reference to the buffer, which outlives the DeviceTensor if needed.
+        return torch::from_blob(
+            memory->data.get(),
+            memory->dims,
+            memory->strides,
+            [data = memory->data](void*) {},
+            options
+        );
+    }
     return torch::from_blob(
         memory->data.get(),
         memory->dims,
@@ -201,17 +251,35 @@ torch::Tensor device_to_host(const std::shared_ptr<DeviceTensor<T>>& memory) {
     ).clone();  // clone to detach from external buffer if needed
 }
 
+template <typename T>
+bool is_montgomery(const std::shared_ptr<DeviceTensor<T>>& memory) {
+    return memory->montgomery;
+}
+
+template <typename T>
+int numa_node_of(const std::shared_ptr<DeviceTensor<T>>& memory) {
+    return buffer_numa_node(memory->data.get(), span_bytes<T>(memory->dims, memory->strides));
+}
+
 // Explicit instantiations
 template std::shared_ptr<DeviceTensor<int32_t>> allocate_on_hardware<int32_t>(const std::vector<int64_t>&);
 template std::shared_ptr<DeviceTensor<int64_t>> allocate_on_hardware<int64_t>(const std::vector<int64_t>&);
 template std::shared_ptr<DeviceTensor<double>> allocate_on_hardware<double>(const std::vector<int64_t>&);
 
-template std::shared_ptr<DeviceTensor<int32_t>> host_to_device<int32_t>(const torch::Tensor&);
-template std::shared_ptr<DeviceTensor<int64_t>> host_to_device<int64_t>(const torch::Tensor&);
-template std::shared_ptr<DeviceTensor<double>> host_to_device<double>(const torch::Tensor&);
+template std::shared_ptr<DeviceTensor<int32_t>> host_to_device<int32_t>(const torch::Tensor&, bool);
+template std::shared_ptr<DeviceTensor<int64_t>> host_to_device<int64_t>(const torch::Tensor&, bool);
+template std::shared_ptr<DeviceTensor<double>> host_to_device<double>(const torch::Tensor&, bool);
+
+template torch::Tensor device_to_host<int32_t>(const std::shared_ptr<DeviceTensor<int32_t>>&, bool);
+template torch::Tensor device_to_host<int64_t>(const std::shared_ptr<DeviceTensor<int64_t>>&, bool);
+template torch::Tensor device_to_host<double>(const std::shared_ptr<DeviceTensor<double>>&, bool);
+
+template bool is_montgomery<int32_t>(const std::shared_ptr<DeviceTensor<int32_t>>&);
+template bool is_montgomery<int64_t>(const std::shared_ptr<DeviceTensor<int64_t>>&);
+template bool is_montgomery<double>(const std::shared_ptr<DeviceTensor<double>>&);
 
-template torch::Tensor device_to_host<int32_t>(const std::shared_ptr<DeviceTensor<int32_t>>&);
-template torch::Tensor device_to_host<int64_t>(const std::shared_ptr<DeviceTensor<int64_t>>&);
-template torch::Tensor device_to_host<double>(const std::shared_ptr<DeviceTensor<double>>&);
+template int numa_node_of<int32_t>(const std::shared_ptr<DeviceTensor<int32_t>>&);
+template int numa_node_of<int64_t>(const std::shared_ptr<DeviceTensor<int64_t>>&);
+template int numa_node_of<double>(const std::shared_ptr<DeviceTensor<double>>&);
 
 } // namespace lattica_hw_api
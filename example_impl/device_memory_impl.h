@@ -13,11 +13,20 @@ struct DeviceTensor {
     std::vector<int64_t> dims;
     std::vector<int64_t> strides;
     std::shared_ptr<void> data;
+    // Values are held in Montgomery form (x * 2^bits(T) mod p); set by to_montgomery and
+    // carried through the ops that accept such tensors (modop.h).
+    bool montgomery = false;
 
+    // Copies the elements spanned by dims / strides from src_data into a new buffer.
     DeviceTensor(const std::vector<int64_t>& dims,
                  const std::vector<int64_t>& strides,
                  const void* src_data);
 
+    // Adopts `buffer`, which must span dims / strides.
+    DeviceTensor(const std::vector<int64_t>& dims,
+                 const std::vector<int64_t>& strides,
+                 std::shared_ptr<void> buffer);
+
     void reshape(const std::vector<int64_t>& new_dims);
     void print() const;
     void print_metadata() const;
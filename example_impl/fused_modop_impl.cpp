@@ -0,0 +1,278 @@
+#include "device_memory_impl.h"
+#include "fused_modop.h"
+#include "modop_kernels.h"
+#include "strided_loop.h"
+#include <algorithm>
+#include <array>
+#include <stdexcept>
+#include <string>
+#include <omp.h>
+
+namespace lattica_hw_api {
+
+// ---- Building ----
+
+template <typename T>
+typename FusedModop<T>::Node FusedModop<T>::input(const std::shared_ptr<DeviceTensor<T>>& tensor) {
+    if (!tensor) throw std::invalid_argument("input tensor must not be null.");
+    Step step{Op::input};
+    step.tensor = tensor;
+    steps_.push_back(step);
+    return static_cast<Node>(steps_.size()) - 1;
+}
+
+template <typename T>
+typename FusedModop<T>::Node FusedModop<T>::scalar(T value) {
+    Step step{Op::scalar};
+    step.value = value;
+    steps_.push_back(step);
+    return static_cast<Node>(steps_.size()) - 1;
+}
+
+template <typename T>
+typename FusedModop<T>::Node FusedModop<T>::add_op(Op op, Node a, Node b, Node p) {
+    const Node n = static_cast<Node>(steps_.size());
+    for (Node operand : {a, b}) {
+        if (operand < 0 || operand >= n) throw std::invalid_argument("Operand is not a node of this graph.");
+    }
+    if (op != Op::mod) {
+        if (p < 0 || p >= n) throw std::invalid_argument("Modulus is not a node of this graph.");
+        if (steps_[p].op != Op::input && steps_[p].op != Op::scalar)
+            throw std::invalid_argument("Modulus must be an input or scalar node.");
+    }
+    Step step{op};
+    step.a = a;
+    step.b = b;
+    step.p = p;
+    steps_.push_back(step);
+    return n;
+}
+
+template <typename T>
+typename FusedModop<T>::Node FusedModop<T>::modsum(Node a, Node b, Node p) {
+    return add_op(Op::modsum, a, b, p);
+}
+
+template <typename T>
+typename FusedModop<T>::Node FusedModop<T>::modmul(Node a, Node b, Node p) {
+    return add_op(Op::modmul, a, b, p);
+}
+
+template <typename T>
+typename FusedModop<T>::Node FusedModop<T>::mod(Node a, Node b) {
+    return add_op(Op::mod, a, b, -1);
+}
+
+// ---- Evaluation ----
+//
+// The result and the tensor leaves read as values are the operands of one StridedLoop;
+// moduli are not, since a scalar or [k] p is indexed by the position along the last
+// axis, which lets dense inputs merge into a single flat run. Each run is cut into tiles
+// of contiguous_chunk elements and every needed node is computed over the tile in order.
+// A node's tile is a pointer with step 1 (dense) or 0 (one value for the whole tile).
+
+namespace {
+
+constexpr size_t fused_operands = max_fused_inputs + 1;
+
+template <typename T>
+struct TileValue {
+    const T* data;
+    int64_t step;
+};
+
+template <typename T>
+struct FusedPlan {
+    using Step = typename FusedModop<T>::Step;
+    using Op = typename FusedModop<T>::Op;
+
+    const std::vector<Step>& steps;
+    std::vector<int64_t> order;                              // needed nodes, ascending
+    std::vector<int64_t> operand;                            // loop operand of an input leaf, or -1
+    std::vector<std::shared_ptr<const ModulusTable<T>>> table;  // per modsum / modmul node
+    int64_t k = 1;                                           // moduli per row (1 or last dim)
+};
+
+// (a op b) % q over the tile with the generic path's signed double-width `%`, for moduli
+// outside the Barrett / positive range.
+template <typename T, ModopKind Kind>
+void generic_modop_tile(T* r, TileValue<T> a, TileValue<T> b, const T* q, int64_t count) {
+    for (int64_t i = 0; i < count; ++i) {
+        const T_DP<T> x = a.data[i * a.step], y = b.data[i * b.step];
+        const T_DP<T> v = Kind == ModopKind::sum ? x + y : x * y;
+        r[i] = static_cast<T>(v % static_cast<T_DP<T>>(q[i]));
+    }
+}
+
+template <typename T, ModopKind Kind>
+void modop_tile(SimdLevel level, T* r, TileValue<T> a, TileValue<T> b, const ModulusTable<T>& table,
+                int64_t t, int64_t count) {
+    if (!(Kind == ModopKind::mul ? table.barrett : table.positive)) {
+        generic_modop_tile<T, Kind>(r, a, b, &table.p[t], count);
+        return;
+    }
+    // The span kernels need a dense `a`; both ops commute, and a tile where both operands
+    // are single values is widened into r first (the kernels allow r to alias a).
+    if (a.step == 0 && b.step == 1) std::swap(a, b);
+    if (a.step == 0) {
+        std::fill(r, r + count, a.data[0]);
+        a = {r, 1};
+    }
+    run_modop_span<T, Kind>(level, r, a.data, b.data, b.step, count, table, t);
+}
+
+template <typename T>
+void evaluate_tile(const FusedPlan<T>& plan, SimdLevel level, T* buffers, TileValue<T>* values,
+                   const std::vector<const T*>& inputs, const std::array<int64_t, fused_operands>& offset,
+                   const std::array<int64_t, fused_operands>& stride, int64_t pos, int64_t count) {
+    using Op = typename FusedPlan<T>::Op;
+    const int64_t column = pos % plan.k;
+
+    for (int64_t i : plan.order) {
+        const auto& step = plan.steps[i];
+        T* out = buffers + i * contiguous_chunk;
+        switch (step.op) {
+        case Op::input: {
+            const int64_t o = plan.operand[i];
+            const T* src = inputs[o] + offset[o];
+            const int64_t s = stride[o];
+            if (s == 0 || s == 1) {
+                values[i] = {src, s};
+            } else {
+                for (int64_t j = 0; j < count; ++j) out[j] = src[j * s];
+                values[i] = {out, 1};
+            }
+            break;
+        }
+        case Op::scalar:
+            values[i] = {&step.value, 0};
+            break;
+        case Op::modsum:
+        case Op::modmul: {
+            // Element j of the tile uses modulus (column + j) % k: consecutive entries of the
+            // cyclic table, starting at column (or entry 0 for a single modulus).
+            const ModulusTable<T>& table = *plan.table[i];
+            const int64_t t = table.k == 1 ? 0 : column;
+            if (step.op == Op::modsum)
+                modop_tile<T, ModopKind::sum>(level, out, values[step.a], values[step.b], table, t, count);
+            else
+                modop_tile<T, ModopKind::mul>(level, out, values[step.a], values[step.b], table, t, count);
+            values[i] = {out, 1};
+            break;
+        }
+        case Op::mod: {
+            const TileValue<T> a = values[step.a], b = values[step.b];
+            for (int64_t j = 0; j < count; ++j) out[j] = static_cast<T>(a.data[j * a.step] % b.data[j * b.step]);
+            values[i] = {out, 1};
+            break;
+        }
+        }
+    }
+}
+
+template <typename T>
+void check_broadcastable(const DeviceTensor<T>& tensor, const std::vector<int64_t>& dims, const char* label) {
+    if (tensor.dims.size() > dims.size()) throw std::invalid_argument(std::string(label) + " has more dims than result.");
+    for (size_t i = 1; i <= tensor.dims.size(); ++i) {
+        const int64_t d = tensor.dims[tensor.dims.size() - i];
+        if (d != 1 && d != dims[dims.size() - i])
+            throw std::invalid_argument(std::string(label) + " not broadcast-compatible with result.");
+    }
+}
+
+} // namespace
+
+template <typename T>
+void FusedModop<T>::evaluate(Node node, std::shared_ptr<DeviceTensor<T>>& result) const {
+    const int64_t n = static_cast<int64_t>(steps_.size());
+    if (node < 0 || node >= n) throw std::invalid_argument("Node is not a node of this graph.");
+    if (!result) throw std::invalid_argument("result pointer must not be null.");
+    const std::vector<int64_t>& dims = result->dims;
+
+    FusedPlan<T> plan{steps_};
+    plan.k = dims.empty() ? 1 : dims.back();
+    plan.operand.assign(n, -1);
+    plan.table.resize(n);
+
+    // Nodes the evaluated one depends on: operand ids are always smaller than the op's.
+    std::vector<char> needed(n, 0);
+    needed[node] = 1;
+    for (int64_t i = node; i >= 0; --i) {
+        if (!needed[i] || steps_[i].op == Op::input || steps_[i].op == Op::scalar) continue;
+        needed[steps_[i].a] = needed[steps_[i].b] = 1;
+    }
+
+    std::array<StridedOperand, fused_operands> operands{};
+    std::vector<const T*> inputs(fused_operands, nullptr);
+    std::vector<const DeviceTensor<T>*> operand_tensor(fused_operands, nullptr);
+    operands[0] = StridedOperand(dims, result->strides);
+    int64_t used = 1;
+    for (int64_t i = 0; i <= node; ++i) {
+        if (!needed[i]) continue;
+        plan.order.push_back(i);
+        const Step& step = steps_[i];
+        if (step.op == Op::input) {
+            const DeviceTensor<T>& tensor = *step.tensor;
+            if (tensor.montgomery)
+                throw std::invalid_argument("Fused expressions do not accept Montgomery-form tensors.");
+            check_broadcastable(tensor, dims, "input");
+            const auto same = std::find(operand_tensor.begin() + 1, operand_tensor.begin() + used, &tensor);
+            if (same != operand_tensor.begin() + used) {
+                plan.operand[i] = same - operand_tensor.begin();  // the same tensor added twice
+            } else {
+                if (used == static_cast<int64_t>(fused_operands))
+                    throw std::invalid_argument("Fused expression reads more than max_fused_inputs tensors.");
+                operands[used] = StridedOperand(tensor.dims, tensor.strides);
+                inputs[used] = reinterpret_cast<const T*>(tensor.data.get());
+                operand_tensor[used] = &tensor;
+                plan.operand[i] = used++;
+            }
+        } else if (step.op == Op::modsum || step.op == Op::modmul) {
+            const Step& p = steps_[step.p];
+            const ModopInput<T> p_input = p.op == Op::scalar ? ModopInput<T>::scalar(p.value)
+                                                             : ModopInput<T>::tensor(p.tensor);
+            if (p_input.layout.ndim > 1)
+                throw std::invalid_argument("Modulus must be a scalar or a 1D tensor.");
+            const int64_t k = p_input.layout.ndim == 0 ? 1 : p_input.layout.dims[0];
+            if (k != 1 && k != plan.k)
+                throw std::invalid_argument("Modulus length must be 1 or the last dimension of result.");
+            plan.table[i] = get_modulus_table<T>(p_input);
+        }
+    }
+    T* out = reinterpret_cast<T*>(result->data.get());
+    const StridedLoop<fused_operands> loop(dims, operands);
+    const SimdLevel level = simd_level();
+
+    #pragma omp parallel if (loop.numel() >= 32768)
+    {
+        std::vector<T> buffers(n * contiguous_chunk);
+        std::vector<TileValue<T>> values(n);
+        const int64_t threads = omp_get_num_threads();
+        const int64_t thread = omp_get_thread_num();
+        const int64_t numel = loop.numel();
+
+        loop.run(numel * thread / threads, numel * (thread + 1) / threads,
+                 [&](int64_t pos, const std::array<int64_t, fused_operands>& offset,
+                     const std::array<int64_t, fused_operands>& stride, int64_t count) {
+            std::array<int64_t, fused_operands> tile_offset = offset;
+            for (int64_t j0 = 0; j0 < count; j0 += contiguous_chunk) {
+                const int64_t m = std::min(contiguous_chunk, count - j0);
+                for (size_t o = 0; o < fused_operands; ++o) tile_offset[o] = offset[o] + j0 * stride[o];
+                evaluate_tile<T>(plan, level, buffers.data(), values.data(), inputs, tile_offset, stride,
+                                 pos + j0, m);
+
+                const TileValue<T> v = values[node];
+                T* r = out + tile_offset[0];
+                const int64_t sr = stride[0];
+                if (v.data == r && v.step == 1 && sr == 1) continue;
+                for (int64_t j = 0; j < m; ++j) r[j * sr] = v.data[j * v.step];
+            }
+        });
+    }
+    result->montgomery = false;
+}
+
+template class FusedModop<int32_t>;
+template class FusedModop<int64_t>;
+
+} // namespace lattica_hw_api
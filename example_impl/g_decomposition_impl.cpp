@@ -1,6 +1,7 @@
 
 #include "device_memory_impl.h"
 #include "g_decomposition.h"
+#include "strided_loop.h"
 #include <stdexcept>
 #include <cmath>
 #include <iostream>
@@ -24,46 +25,47 @@ namespace lattica_hw_api {
             !std::equal(in_shape.begin(), in_shape.end(), out_shape.begin())) {
             throw std::invalid_argument("Output must have shape a.shape + [power]");
         }
-
-       // Compute total input elements
-        int64_t total = 1;
-        for (auto d : in_shape) total *= d;
-
-        // Compute strides for index mapping
-        std::vector<int64_t> strides(in_shape.size(), 1);
-        for (int i = in_shape.size() - 2; i >= 0; --i) {
-            strides[i] = strides[i + 1] * in_shape[i + 1];
+        if (a->montgomery) {
+            throw std::invalid_argument("a is in Montgomery form; convert it with from_montgomery first");
         }
+        result->montgomery = false;
 
-        #pragma omp parallel for
-        for (int64_t flat_idx = 0; flat_idx < total; ++flat_idx) {
-            std::vector<int64_t> coord(in_shape.size());
-            int64_t remaining = flat_idx;
-
-            for (size_t i = 0; i < in_shape.size(); ++i) {
-                coord[i] = remaining / strides[i];
-                remaining %= strides[i];
-            }
+        // Walk the input once; the digits of each element sit `digit_stride` apart in result
+        const std::vector<int64_t> out_dims(out_shape.begin(), out_shape.end() - 1);
+        const std::vector<int64_t> out_strides(result->strides.begin(), result->strides.end() - 1);
+        const int64_t digit_stride = result->strides.back();
+        const T* src_ptr = reinterpret_cast<const T*>(a->data.get());
+        T* dst_ptr = reinterpret_cast<T*>(result->data.get());
 
-            T value = a->at(coord);
-            std::vector<int64_t> out_coord = coord;
-            out_coord.push_back(0);
+        const StridedLoop<2> loop(in_shape, {StridedOperand(in_shape, a->strides),
+                                             StridedOperand(out_dims, out_strides)});
+        loop.parallel_run([&](int64_t pos, const std::array<int64_t, 2>& offset,
+                              const std::array<int64_t, 2>& stride, int64_t count) {
+            for (int64_t j = 0; j < count; ++j) {
+                T value = src_ptr[offset[0] + j * stride[0]];
+                T* out = dst_ptr + offset[1] + j * stride[1];
 
-            for (size_t d = 0; d < power; ++d) {
-                out_coord.back() = d;
-                result->at(out_coord) = value % base;
-                value /= base;
-            }
+                for (size_t d = 0; d < power; ++d) {
+                    out[static_cast<int64_t>(d) * digit_stride] = value % base;
+                    value /= base;
+                }
 
-            if (value > 0) {
-                #pragma omp critical
-                {
-                    std::cerr << "Warning: value at ";
-                    for (auto x : coord) std::cerr << x << " ";
-                    std::cerr << "exceeds capacity with base_bits=" << base_bits << " and power=" << power << "\n";
+                if (value > 0) {
+                    std::vector<int64_t> coord(in_shape.size());
+                    int64_t remaining = pos + j;
+                    for (int64_t i = in_shape.size() - 1; i >= 0; --i) {
+                        coord[i] = remaining % in_shape[i];
+                        remaining /= in_shape[i];
+                    }
+                    #pragma omp critical
+                    {
+                        std::cerr << "Warning: value at ";
+                        for (auto x : coord) std::cerr << x << " ";
+                        std::cerr << "exceeds capacity with base_bits=" << base_bits << " and power=" << power << "\n";
+                    }
                 }
             }
-        }
+        });
     }
 
     template void g_decomposition<int32_t>(
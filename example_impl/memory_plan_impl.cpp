@@ -0,0 +1,171 @@
+#include "memory_plan_impl.h"
+#include "memory_pool_impl.h"
+
+#include <algorithm>
+#include <map>
+#include <mutex>
+#include <numeric>
+#include <queue>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+namespace lattica_hw_api {
+
+namespace {
+
+int64_t aligned_bytes(int64_t bytes) {
+    return (bytes + memory_pool_alignment - 1) / memory_pool_alignment * memory_pool_alignment;
+}
+
+// Best-fit allocator over offsets [0, end) of an arena that grows on demand.
+class ArenaFit {
+public:
+    int64_t allocate(int64_t bytes) {
+        // Smallest gap that holds `bytes`, lowest offset among equals
+        auto fit = by_size_.lower_bound({bytes, 0});
+        if (fit != by_size_.end()) {
+            const auto [size, offset] = *fit;
+            erase(offset, size);
+            if (size > bytes) insert(offset + bytes, size - bytes);
+            return offset;
+        }
+        // None: extend the arena, starting inside a trailing gap if there is one
+        int64_t offset = end_;
+        if (!by_offset_.empty()) {
+            const auto last = std::prev(by_offset_.end());
+            if (last->first + last->second == end_) {
+                offset = last->first;
+                erase(last->first, last->second);
+            }
+        }
+        end_ = offset + bytes;
+        high_water_ = std::max(high_water_, end_);
+        return offset;
+    }
+
+    void release(int64_t offset, int64_t bytes) {
+        // Coalesce with the gaps on either side
+        auto next = by_offset_.lower_bound(offset);
+        if (next != by_offset_.end() && next->first == offset + bytes) {
+            bytes += next->second;
+            erase(next->first, next->second);
+        }
+        auto prev = by_offset_.lower_bound(offset);
+        if (prev != by_offset_.begin()) {
+            --prev;
+            if (prev->first + prev->second == offset) {
+                offset = prev->first;
+                bytes += prev->second;
+                erase(prev->first, prev->second);
+            }
+        }
+        insert(offset, bytes);
+    }
+
+    int64_t high_water() const { return high_water_; }
+
+private:
+    void insert(int64_t offset, int64_t bytes) {
+        by_offset_[offset] = bytes;
+        by_size_.insert({bytes, offset});
+    }
+
+    void erase(int64_t offset, int64_t bytes) {
+        by_offset_.erase(offset);
+        by_size_.erase({bytes, offset});
+    }
+
+    std::map<int64_t, int64_t> by_offset_;          // gap offset -> size
+    std::set<std::pair<int64_t, int64_t>> by_size_;   // (size, offset)
+    int64_t end_ = 0;
+    int64_t high_water_ = 0;
+};
+
+struct ActivePlan {
+    std::shared_ptr<void> arena;
+    std::vector<int64_t> bytes;
+    std::vector<int64_t> offsets;
+    size_t next = 0;
+};
+
+std::mutex plan_mutex;
+std::unique_ptr<ActivePlan> active_plan;
+
+} // namespace
+
+MemoryPlan::MemoryPlan(const std::vector<BufferLifetime>& buffers) : buffers_(buffers), offsets_(buffers.size(), 0) {
+    for (const BufferLifetime& b : buffers_) {
+        if (b.bytes < 0 || b.first < 0 || b.last < b.first)
+            throw std::invalid_argument("Buffer lifetimes need bytes >= 0 and 0 <= first <= last.");
+    }
+
+    // Replay in step order; at equal steps, in the order the buffers were listed. A buffer
+    // is released before any buffer whose first step comes after its last one.
+    std::vector<size_t> order(buffers_.size());
+    std::iota(order.begin(), order.end(), size_t(0));
+    std::stable_sort(order.begin(), order.end(),
+                     [&](size_t a, size_t b) { return buffers_[a].first < buffers_[b].first; });
+
+    using Live = std::pair<int64_t, size_t>;  // (last step, buffer)
+    std::priority_queue<Live, std::vector<Live>, std::greater<Live>> live;
+    ArenaFit arena;
+    int64_t live_bytes = 0;
+    for (size_t i : order) {
+        while (!live.empty() && live.top().first < buffers_[i].first) {
+            const size_t done = live.top().second;
+            live.pop();
+            arena.release(offsets_[done], aligned_bytes(buffers_[done].bytes));
+            live_bytes -= aligned_bytes(buffers_[done].bytes);
+        }
+        const int64_t bytes = aligned_bytes(buffers_[i].bytes);
+        offsets_[i] = bytes == 0 ? 0 : arena.allocate(bytes);
+        if (bytes > 0) live.push({buffers_[i].last, i});
+        live_bytes += bytes;
+        max_live_bytes_ = std::max(max_live_bytes_, live_bytes);
+    }
+    arena_bytes_ = arena.high_water();
+}
+
+std::shared_ptr<void> planned_allocate(size_t bytes) {
+    std::shared_ptr<void> buffer;
+    {
+        std::lock_guard<std::mutex> lock(plan_mutex);
+        if (!active_plan || active_plan->next == active_plan->offsets.size()) return nullptr;
+        const size_t i = active_plan->next;
+        if (static_cast<int64_t>(bytes) > active_plan->bytes[i])
+            throw std::runtime_error("allocate_on_hardware asked for " + std::to_string(bytes) +
+                                     " bytes, but buffer " + std::to_string(i) + " of the memory plan has " +
+                                     std::to_string(active_plan->bytes[i]) + ".");
+        ++active_plan->next;
+        // Aliases the arena, so the buffer keeps it alive.
+        buffer = std::shared_ptr<void>(active_plan->arena,
+                                       static_cast<char*>(active_plan->arena.get()) + active_plan->offsets[i]);
+    }
+    touch_partitioned(buffer.get(), nullptr, bytes);
+    return buffer;
+}
+
+void begin_memory_plan(const MemoryPlan& plan) {
+    auto next = std::make_unique<ActivePlan>();
+    next->arena = device_allocate(static_cast<size_t>(plan.arena_bytes()), false);
+    for (int64_t i = 0; i < plan.num_buffers(); ++i) {
+        next->bytes.push_back(plan.buffer(i).bytes);
+        next->offsets.push_back(plan.offset(i));
+    }
+    std::lock_guard<std::mutex> lock(plan_mutex);
+    active_plan = std::move(next);
+}
+
+void end_memory_plan() {
+    std::lock_guard<std::mutex> lock(plan_mutex);
+    active_plan.reset();
+}
+
+int64_t memory_plan_position() {
+    std::lock_guard<std::mutex> lock(plan_mutex);
+    return active_plan ? static_cast<int64_t>(active_plan->next) : -1;
+}
+
+} // namespace lattica_hw_api
@@ -0,0 +1,21 @@
+#ifndef MEMORY_PLAN_IMPL_H
+#define MEMORY_PLAN_IMPL_H
+
+#include "memory_plan.h"
+
+#include <cstddef>
+#include <memory>
+
+namespace lattica_hw_api {
+
+/**
+ * @brief The next buffer of the active memory plan, zero-filled, or nullptr when no plan
+ *        is active or all of its buffers have been handed out.
+ *
+ * Throws std::runtime_error if `bytes` exceeds the planned size of that buffer.
+ */
+std::shared_ptr<void> planned_allocate(size_t bytes);
+
+} // namespace lattica_hw_api
+
+#endif // MEMORY_PLAN_IMPL_H
@@ -0,0 +1,412 @@
+#include "memory_pool.h"
+#include "memory_pool_impl.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <new>
+#include <omp.h>
+#include <stdexcept>
+#include <unordered_map>
+#include <vector>
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#if defined(LATTICA_HAVE_LIBNUMA)
+#include <numa.h>
+#endif
+
+namespace lattica_hw_api {
+
+namespace {
+
+constexpr size_t min_block_bytes = 64;
+constexpr size_t huge_page_bytes = size_t(1) << 21;
+constexpr size_t parallel_touch_bytes = size_t(1) << 18;
+
+static_assert(min_block_bytes % memory_pool_alignment == 0, "Blocks must hold whole cache lines.");
+
+// Rounds up to a multiple of a quarter of the largest power of two below `bytes`.
+size_t size_class(size_t bytes) {
+    if (bytes <= min_block_bytes) return min_block_bytes;
+    const int log2 = 63 - __builtin_clzll(static_cast<unsigned long long>(bytes - 1));
+    const size_t step = size_t(1) << (log2 - 2);
+    return (bytes + step - 1) & ~(step - 1);
+}
+
+size_t mapping_bytes(size_t block) {
+    return (block + huge_page_bytes - 1) & ~(huge_page_bytes - 1);
+}
+
+HugePageMode huge_page_mode_from_env() {
+    if (const char* env = std::getenv("LATTICA_HUGE_PAGES")) {
+        if (std::strcmp(env, "off") == 0) return HugePageMode::off;
+        if (std::strcmp(env, "explicit") == 0) return HugePageMode::explicit_pages;
+    }
+    return HugePageMode::transparent;
+}
+
+#if defined(__linux__)
+
+// A 2 MiB-aligned anonymous mapping of `length` bytes (a multiple of 2 MiB), so that the
+// kernel can back it with huge pages: map one page more, then unmap the unaligned ends.
+void* map_aligned(size_t length) {
+    void* raw = mmap(nullptr, length + huge_page_bytes, PROT_READ | PROT_WRITE,
+                     MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (raw == MAP_FAILED) return nullptr;
+    const uintptr_t start = reinterpret_cast<uintptr_t>(raw);
+    const uintptr_t aligned = (start + huge_page_bytes - 1) & ~uintptr_t(huge_page_bytes - 1);
+    if (aligned > start) munmap(raw, aligned - start);
+    const size_t tail = (start + length + huge_page_bytes) - (aligned + length);
+    if (tail > 0) munmap(reinterpret_cast<void*>(aligned + length), tail);
+    return reinterpret_cast<void*>(aligned);
+}
+
+#endif
+
+bool numa_supported() {
+#if defined(LATTICA_HAVE_LIBNUMA)
+    return numa_available() >= 0;
+#else
+    return false;
+#endif
+}
+
+// Places the pages of a fresh mapping before anything touches them.
+void apply_numa_policy(void* p, size_t length, NumaPolicy policy, int node) {
+#if defined(LATTICA_HAVE_LIBNUMA)
+    if (policy == NumaPolicy::interleave)
+        numa_interleave_memory(p, length, numa_all_nodes_ptr);
+    else if (policy == NumaPolicy::bind)
+        numa_tonode_memory(p, length, node);
+#else
+    (void)p;
+    (void)length;
+    (void)policy;
+    (void)node;
+#endif
+}
+
+// A fresh, untouched buffer of `block` bytes under `mode`; mappings are zero-filled by
+// the kernel, other buffers hold garbage.
+void* allocate_block(size_t block, HugePageMode mode, size_t threshold, NumaPolicy policy, int node,
+                     PageBacking& backing) {
+#if defined(__linux__)
+    if (block >= threshold) {
+        const size_t length = mapping_bytes(block);
+        void* p = nullptr;
+        if (mode == HugePageMode::explicit_pages) {
+            p = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+            if (p == MAP_FAILED) p = nullptr;
+            else backing = PageBacking::explicit_huge;
+        }
+        if (!p && (p = map_aligned(length))) {
+            if (mode != HugePageMode::off) madvise(p, length, MADV_HUGEPAGE);
+            backing = mode == HugePageMode::off ? PageBacking::mapped : PageBacking::transparent_huge;
+        }
+        if (p) {
+            apply_numa_policy(p, length, policy, node);
+            return p;
+        }
+    }
+#else
+    (void)mode;
+    (void)threshold;
+    (void)policy;
+    (void)node;
+#endif
+    void* p = nullptr;
+    if (posix_memalign(&p, memory_pool_alignment, block) != 0) return nullptr;
+    backing = PageBacking::standard;
+    return p;
+}
+
+void free_block(void* buffer, size_t block, PageBacking backing) {
+#if defined(__linux__)
+    if (backing != PageBacking::standard) {
+        munmap(buffer, mapping_bytes(block));
+        return;
+    }
+#else
+    (void)block;
+    (void)backing;
+#endif
+    std::free(buffer);
+}
+
+class MemoryPool {
+public:
+    // Never destroyed: buffers held by static tensors may be released after main().
+    static MemoryPool& instance() {
+        static MemoryPool* pool = new MemoryPool();
+        return *pool;
+    }
+
+    std::shared_ptr<void> allocate(size_t bytes, bool zero) {
+        const size_t block = size_class(bytes);
+        CachedBlock cached{nullptr, PageBacking::standard};
+        HugePageMode mode;
+        size_t threshold;
+        NumaPolicy policy;
+        int node;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            auto& list = free_lists_[block];
+            if (!list.empty()) {
+                cached = list.back();
+                list.pop_back();
+                stats_.cached_bytes -= block;
+                ++stats_.hits;
+            } else {
+                ++stats_.misses;
+            }
+            stats_.live_bytes += block;
+            stats_.peak_live_bytes = std::max(stats_.peak_live_bytes, stats_.live_bytes);
+            mode = huge_page_mode_;
+            threshold = huge_page_threshold_;
+            policy = numa_policy_;
+            node = numa_node_;
+        }
+        const bool reused = cached.buffer != nullptr;
+        if (!reused) {
+            cached.buffer = allocate_block(block, mode, threshold, policy, node, cached.backing);
+            if (!cached.buffer) {
+                std::lock_guard<std::mutex> lock(mutex_);
+                stats_.live_bytes -= block;
+                throw std::bad_alloc();
+            }
+        }
+        // A fresh mapping is zero already, but under first touch writing it is what places
+        // its pages next to the threads that will use them.
+        const bool fresh_mapping = !reused && cached.backing != PageBacking::standard;
+        if (zero && !(fresh_mapping && policy != NumaPolicy::first_touch))
+            touch_partitioned(cached.buffer, nullptr, bytes);
+        return std::shared_ptr<void>(cached.buffer, PoolDeleter{block, cached.backing});
+    }
+
+    void recycle(void* buffer, size_t block, PageBacking backing) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stats_.live_bytes -= block;
+            if (stats_.cached_bytes + static_cast<int64_t>(block) <= cache_limit_) {
+                free_lists_[block].push_back({buffer, backing});
+                stats_.cached_bytes += block;
+                return;
+            }
+        }
+        free_block(buffer, block, backing);
+    }
+
+    MemoryPoolStats stats() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return stats_;
+    }
+
+    void reset_stats() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stats_.hits = stats_.misses = 0;
+        stats_.peak_live_bytes = stats_.live_bytes;
+    }
+
+    void set_cache_limit(int64_t bytes) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        cache_limit_ = bytes;
+        trim(cache_limit_);
+    }
+
+    void release_cache() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        trim(0);
+    }
+
+    int64_t cache_limit() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return cache_limit_;
+    }
+
+    void set_huge_pages(HugePageMode mode, size_t threshold) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        huge_page_mode_ = mode;
+        huge_page_threshold_ = threshold;
+    }
+
+    HugePageMode huge_page_mode() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return huge_page_mode_;
+    }
+
+    size_t huge_page_threshold() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return huge_page_threshold_;
+    }
+
+    void set_numa_policy(NumaPolicy policy, int node) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        numa_policy_ = policy;
+        numa_node_ = node;
+    }
+
+    NumaPolicy numa_policy() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return numa_policy_;
+    }
+
+    int numa_node() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return numa_node_;
+    }
+
+private:
+    struct CachedBlock {
+        void* buffer;
+        PageBacking backing;
+    };
+
+    MemoryPool() = default;
+
+    // Frees cached buffers until the free lists hold at most `limit` bytes. Called with
+    // mutex_ held.
+    void trim(int64_t limit) {
+        for (auto& [block, list] : free_lists_) {
+            while (stats_.cached_bytes > limit && !list.empty()) {
+                free_block(list.back().buffer, block, list.back().backing);
+                list.pop_back();
+                stats_.cached_bytes -= block;
+            }
+        }
+    }
+
+    std::mutex mutex_;
+    std::unordered_map<size_t, std::vector<CachedBlock>> free_lists_;
+    MemoryPoolStats stats_;
+    int64_t cache_limit_ = int64_t(1) << 30;
+    HugePageMode huge_page_mode_ = huge_page_mode_from_env();
+    size_t huge_page_threshold_ = huge_page_bytes;
+    NumaPolicy numa_policy_ = NumaPolicy::first_touch;
+    int numa_node_ = -1;
+};
+
+} // namespace
+
+const char* page_backing_name(PageBacking backing) {
+    switch (backing) {
+    case PageBacking::transparent_huge: return "transparent huge pages";
+    case PageBacking::explicit_huge: return "explicit huge pages";
+    default: return "standard pages";
+    }
+}
+
+void touch_partitioned(void* dst, const void* src, size_t bytes) {
+    // Thread t of n writes bytes [t * bytes / n, (t + 1) * bytes / n): the share of a
+    // contiguous tensor the kernels' static split over elements gives it.
+    #pragma omp parallel if (bytes >= parallel_touch_bytes)
+    {
+        const size_t threads = omp_get_num_threads();
+        const size_t thread = omp_get_thread_num();
+        const size_t begin = bytes * thread / threads, end = bytes * (thread + 1) / threads;
+        char* d = static_cast<char*>(dst) + begin;
+        if (src) std::memcpy(d, static_cast<const char*>(src) + begin, end - begin);
+        else std::memset(d, 0, end - begin);
+    }
+}
+
+int buffer_numa_node(const void* buffer, size_t bytes) {
+#if defined(LATTICA_HAVE_LIBNUMA)
+    if (!numa_supported() || !buffer || bytes == 0) return -1;
+    // Up to 64 pages spread over the buffer stand in for all of them.
+    const uintptr_t page = static_cast<uintptr_t>(sysconf(_SC_PAGESIZE));
+    const uintptr_t start = reinterpret_cast<uintptr_t>(buffer) & ~(page - 1);
+    const uintptr_t pages = (reinterpret_cast<uintptr_t>(buffer) + bytes - start + page - 1) / page;
+    const uintptr_t samples = std::min<uintptr_t>(pages, 64);
+    std::vector<void*> addresses(samples);
+    std::vector<int> status(samples);
+    for (uintptr_t i = 0; i < samples; ++i)
+        addresses[i] = reinterpret_cast<void*>(start + pages * i / samples * page);
+    if (numa_move_pages(0, samples, addresses.data(), nullptr, status.data(), 0) != 0) return -1;
+
+    std::vector<int64_t> count(numa_max_node() + 1, 0);
+    for (int s : status) {
+        if (s >= 0 && s < static_cast<int>(count.size())) ++count[s];  // negative: not touched yet
+    }
+    const auto most = std::max_element(count.begin(), count.end());
+    return *most == 0 ? -1 : static_cast<int>(most - count.begin());
+#else
+    (void)buffer;
+    (void)bytes;
+    return -1;
+#endif
+}
+
+void PoolDeleter::operator()(void* buffer) const {
+    MemoryPool::instance().recycle(buffer, block, backing);
+}
+
+std::shared_ptr<void> device_allocate(size_t bytes, bool zero) {
+    return MemoryPool::instance().allocate(bytes, zero);
+}
+
+MemoryPoolStats get_memory_pool_stats() {
+    return MemoryPool::instance().stats();
+}
+
+void reset_memory_pool_stats() {
+    MemoryPool::instance().reset_stats();
+}
+
+void release_memory_pool_cache() {
+    MemoryPool::instance().release_cache();
+}
+
+void set_memory_pool_cache_limit(int64_t bytes) {
+    if (bytes < 0)
+        throw std::invalid_argument("Memory pool cache limit must be non-negative.");
+    MemoryPool::instance().set_cache_limit(bytes);
+}
+
+int64_t get_memory_pool_cache_limit() {
+    return MemoryPool::instance().cache_limit();
+}
+
+void set_memory_pool_huge_pages(HugePageMode mode, int64_t threshold_bytes) {
+    if (threshold_bytes < 0)
+        throw std::invalid_argument("Huge-page threshold must be non-negative.");
+    MemoryPool::instance().set_huge_pages(mode, static_cast<size_t>(threshold_bytes));
+}
+
+HugePageMode get_memory_pool_huge_page_mode() {
+    return MemoryPool::instance().huge_page_mode();
+}
+
+int64_t get_memory_pool_huge_page_threshold() {
+    return static_cast<int64_t>(MemoryPool::instance().huge_page_threshold());
+}
+
+int numa_node_count() {
+#if defined(LATTICA_HAVE_LIBNUMA)
+    if (numa_supported()) return numa_max_node() + 1;
+#endif
+    return 1;
+}
+
+void set_memory_pool_numa_policy(NumaPolicy policy, int node) {
+    if (policy != NumaPolicy::first_touch && !numa_supported())
+        throw std::runtime_error("NUMA interleave / bind policies need libnuma and a NUMA-capable kernel.");
+    if (policy == NumaPolicy::bind && (node < 0 || node >= numa_node_count()))
+        throw std::invalid_argument("NUMA node out of range.");
+    MemoryPool::instance().set_numa_policy(policy, policy == NumaPolicy::bind ? node : -1);
+}
+
+NumaPolicy get_memory_pool_numa_policy() {
+    return MemoryPool::instance().numa_policy();
+}
+
+int get_memory_pool_numa_node() {
+    return MemoryPool::instance().numa_node();
+}
+
+} // namespace lattica_hw_api
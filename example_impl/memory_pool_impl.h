@@ -0,0 +1,67 @@
+#ifndef MEMORY_POOL_IMPL_H
+#define MEMORY_POOL_IMPL_H
+
+#include "memory_pool.h"
+
+#include <cstddef>
+#include <memory>
+
+/**
+ * @brief Caching allocator behind every DeviceTensor buffer.
+ *
+ * Requests are rounded up to a size class and served from a free list of blocks of that
+ * class when one is available; a block returns to its free list when the last
+ * shared_ptr to it is released. A transcript that allocates many same-shaped
+ * temporaries therefore reaches the system allocator only for the first few of them.
+ * Hit / miss counters are exposed through get_memory_pool_stats() (memory_pool.h).
+ */
+
+namespace lattica_hw_api {
+
+// How a pool buffer is backed.
+enum class PageBacking {
+    standard,          // posix_memalign
+    mapped,            // anonymous mapping of standard pages (huge pages off)
+    transparent_huge,  // 2 MiB-aligned anonymous mapping with madvise(MADV_HUGEPAGE)
+    explicit_huge,     // MAP_HUGETLB mapping of reserved 2 MiB pages
+};
+
+const char* page_backing_name(PageBacking backing);
+
+// Deleter of every pool buffer: returns it to the free list of its size class.
+// std::get_deleter<PoolDeleter> on a DeviceTensor's data tells pool buffers apart from
+// adopted ones.
+struct PoolDeleter {
+    size_t block;
+    PageBacking backing;
+
+    void operator()(void* buffer) const;
+};
+
+/**
+ * @brief A buffer of at least `bytes` bytes, aligned to memory_pool_alignment and
+ *        zero-filled when `zero` is set.
+ *
+ * Throws std::bad_alloc if the system allocator fails.
+ */
+std::shared_ptr<void> device_allocate(size_t bytes, bool zero);
+
+/**
+ * @brief Copies `bytes` bytes from `src` to `dst`, or zeroes them when `src` is null,
+ *        splitting the range statically over the OpenMP threads the way the kernels split
+ *        a contiguous tensor's elements.
+ *
+ * The first write to a page decides its NUMA node, so filling a fresh buffer this way
+ * puts each thread's share of it on that thread's node. Runs serially below 256 KiB.
+ */
+void touch_partitioned(void* dst, const void* src, size_t bytes);
+
+/**
+ * @brief The NUMA node holding most of the pages of [buffer, buffer + bytes), sampled
+ *        at up to 64 pages; -1 if none of them has been touched or libnuma is missing.
+ */
+int buffer_numa_node(const void* buffer, size_t bytes);
+
+} // namespace lattica_hw_api
+
+#endif // MEMORY_POOL_IMPL_H
@@ -0,0 +1,218 @@
+#ifndef MOD_ARITH_H
+#define MOD_ARITH_H
+
+#include "typing.h"
+
+#include <cstdint>
+
+/**
+ * @brief Scalar modular arithmetic helpers shared by the example kernels.
+ *
+ * Every reducer exposes the same `add`, `sub` and `mul` interface over residues in
+ * [0, p), so kernels can be templated on the reduction strategy.
+ */
+
+namespace lattica_hw_api {
+
+/**
+ * @brief Reference reducer: every result goes through a double-width `%`, so it is
+ *        valid for any positive modulus representable in T.
+ */
+template <typename T>
+struct DivisionReducer {
+    T p;
+
+    T add(T a, T b) const {
+        return static_cast<T>((static_cast<T_DP<T>>(a) + b) % p);
+    }
+    T sub(T a, T b) const {
+        return static_cast<T>((static_cast<T_DP<T>>(a) + p - b) % p);
+    }
+    T mul(T a, T b) const {
+        T_DP<T> prod = static_cast<T_DP<T>>(a) * static_cast<T_DP<T>>(b);
+        return static_cast<T>(prod % static_cast<T_DP<T>>(p));
+    }
+};
+
+/**
+ * @brief Barrett reducer (HAC 14.42) for products of two residues.
+ *
+ * With n = log2p + 1 the bit length of p, mu = ⌊2²ⁿ / p⌋ and x < p², the quotient
+ * estimate ((x >> (n - 1)) * mu) >> (n + 1) is short by at most 2, so two
+ * conditional subtractions finish the reduction. The estimate fits in T_DP<T> as
+ * long as n <= bits(T) - 2, i.e. p < 2^30 for int32 and p < 2^62 for int64.
+ */
+template <typename T>
+struct BarrettReducer {
+    T p;
+    T mu;
+    int n;
+
+    T add(T a, T b) const {
+        T sum = a + b;
+        return sum >= p ? sum - p : sum;
+    }
+    T sub(T a, T b) const {
+        T diff = a - b;
+        return diff < 0 ? diff + p : diff;
+    }
+    T mul(T a, T b) const {
+        T_DP<T> x = static_cast<T_DP<T>>(a) * static_cast<T_DP<T>>(b);
+        T_DP<T> q = ((x >> (n - 1)) * static_cast<T_DP<T>>(mu)) >> (n + 1);
+        T_DP<T> r = x - q * static_cast<T_DP<T>>(p);
+        if (r >= p) r -= p;
+        if (r >= p) r -= p;
+        return static_cast<T>(r);
+    }
+};
+
+/**
+ * @brief Whether BarrettReducer supports p: 2 <= p < 2^(bits(T) - 2), except
+ *        p = 2^(bits(T) - 3), whose mu = 2^(bits(T) - 1) does not fit in T.
+ */
+template <typename T>
+constexpr bool fits_barrett(T p) {
+    constexpr T bound = static_cast<T>(1) << (sizeof(T) * 8 - 2);
+    return p >= 2 && p < bound && p != bound / 2;
+}
+
+/**
+ * @brief Derives the Barrett constants for a modulus accepted by fits_barrett().
+ */
+template <typename T>
+BarrettReducer<T> make_barrett_reducer(T p) {
+    int n = 0;
+    while ((p >> n) != 0) ++n;
+    T mu = static_cast<T>((static_cast<T_DP<T>>(1) << (2 * n)) / static_cast<T_DP<T>>(p));
+    return BarrettReducer<T>{p, mu, n};
+}
+
+/**
+ * @brief Unsigned word types used by the Shoup (Harvey) constant-operand multiply.
+ */
+template <typename T>
+struct ShoupTypes;
+
+template <>
+struct ShoupTypes<int32_t> {
+    using word = uint32_t;
+    using dword = uint64_t;
+};
+
+template <>
+struct ShoupTypes<int64_t> {
+    using word = uint64_t;
+    using dword = unsigned __int128;
+};
+
+template <typename T>
+using ShoupWord = typename ShoupTypes<T>::word;
+
+/**
+ * @brief Shoup companion of a fixed multiplicand w < p: ⌊w · 2^bits / p⌋.
+ */
+template <typename T>
+ShoupWord<T> shoup_precompute(ShoupWord<T> w, ShoupWord<T> p) {
+    using dword = typename ShoupTypes<T>::dword;
+    constexpr int bits = static_cast<int>(sizeof(ShoupWord<T>) * 8);
+    return static_cast<ShoupWord<T>>((static_cast<dword>(w) << bits) / p);
+}
+
+/**
+ * @brief Lazy Shoup multiply: returns x · w mod p in [0, 2p) for any word x.
+ *
+ * One high multiply estimates the quotient; the remainder is computed with wrapping
+ * word arithmetic. Requires p < 2^(bits - 1).
+ */
+template <typename T>
+inline ShoupWord<T> shoup_mul_lazy(ShoupWord<T> x, ShoupWord<T> w, ShoupWord<T> w_shoup, ShoupWord<T> p) {
+    using dword = typename ShoupTypes<T>::dword;
+    constexpr int bits = static_cast<int>(sizeof(ShoupWord<T>) * 8);
+    ShoupWord<T> q = static_cast<ShoupWord<T>>((static_cast<dword>(x) * w_shoup) >> bits);
+    return static_cast<ShoupWord<T>>(x * w - q * p);
+}
+
+/**
+ * @brief BarrettReducer::mul in unsigned word arithmetic, for a, b < p and p accepted
+ *        by fits_barrett(): only the low word of a * b - q * p is needed, and both
+ *        shifted intermediates fit in one word.
+ */
+template <typename T>
+inline ShoupWord<T> barrett_mul_word(ShoupWord<T> a, ShoupWord<T> b, ShoupWord<T> p,
+                                     ShoupWord<T> mu, int log2p) {
+    using word = ShoupWord<T>;
+    using dword = typename ShoupTypes<T>::dword;
+    const dword x = static_cast<dword>(a) * b;
+    const word y = static_cast<word>(x >> log2p);
+    const word q = static_cast<word>((static_cast<dword>(y) * mu) >> (log2p + 2));
+    word r = static_cast<word>(x) - q * p;
+    r -= p & (word(0) - (r >= p));  // branch-free: r is spread over [0, 3p)
+    r -= p & (word(0) - (r >= p));
+    return r;
+}
+
+/**
+ * @brief Montgomery constants for R = 2^bits(T): p_inv = p⁻¹ mod R and r_mod_p = R mod p.
+ *
+ * A value x is held in Montgomery form as x · R mod p; montgomery_mul_word multiplies two
+ * such values without a Barrett quotient estimate.
+ */
+template <typename T>
+struct MontgomeryConstants {
+    ShoupWord<T> p_inv;
+    ShoupWord<T> r_mod_p;
+};
+
+/**
+ * @brief Whether the Montgomery kernels support p: odd and accepted by fits_barrett().
+ */
+template <typename T>
+constexpr bool fits_montgomery(T p) {
+    return fits_barrett(p) && (p & 1) != 0;
+}
+
+/**
+ * @brief Derives the Montgomery constants for a modulus accepted by fits_montgomery().
+ */
+template <typename T>
+MontgomeryConstants<T> make_montgomery_constants(T p) {
+    using word = ShoupWord<T>;
+    using dword = typename ShoupTypes<T>::dword;
+    constexpr int bits = static_cast<int>(sizeof(word) * 8);
+    const word q = static_cast<word>(p);
+    word inv = q;  // q * q ≡ 1 mod 8 for odd q; each Newton step doubles the correct bits
+    for (int correct = 3; correct < bits; correct *= 2) inv *= word(2) - q * inv;
+    return {inv, static_cast<word>((static_cast<dword>(1) << bits) % q)};
+}
+
+/**
+ * @brief Montgomery product a · b · R⁻¹ mod p for a, b < p and p accepted by
+ *        fits_montgomery().
+ *
+ * m = (a · b) · p_inv mod R makes m · p agree with a · b in the low word, so
+ * (a · b - m · p) / R is the difference of the high words, which lies in (-p, p).
+ */
+template <typename T>
+inline ShoupWord<T> montgomery_mul_word(ShoupWord<T> a, ShoupWord<T> b, ShoupWord<T> p,
+                                        ShoupWord<T> p_inv) {
+    using word = ShoupWord<T>;
+    using dword = typename ShoupTypes<T>::dword;
+    constexpr int bits = static_cast<int>(sizeof(word) * 8);
+    const dword x = static_cast<dword>(a) * b;
+    const word m = static_cast<word>(x) * p_inv;
+    const word x_hi = static_cast<word>(x >> bits);
+    const word mp_hi = static_cast<word>((static_cast<dword>(m) * p) >> bits);
+    return x_hi - mp_hi + (p & (word(0) - (x_hi < mp_hi)));
+}
+
+/**
+ * @brief Largest modulus (exclusive) for which values may be kept lazily in [0, 4p).
+ */
+template <typename T>
+constexpr ShoupWord<T> lazy_modulus_bound() {
+    return static_cast<ShoupWord<T>>(1) << (sizeof(ShoupWord<T>) * 8 - 2);
+}
+
+} // namespace lattica_hw_api
+
+#endif // MOD_ARITH_H
@@ -1,6 +1,13 @@
 #include "device_memory_impl.h"
 #include "modop.h"
+#include "modop_kernels.h"
 #include "typing.h"
+#include "mod_arith.h"
+#include "simd_dispatch.h"
+#include "simd_kernels.h"
+#include "strided_loop.h"
+#include <algorithm>
+#include <atomic>
 #include <numeric>
 #include <stdexcept>
 #include <functional>
@@ -10,75 +17,434 @@
 
 namespace lattica_hw_api {
 
-template <typename T, typename AGetter, typename BGetter, typename CombineOp>
+template <typename T, typename CombineOp>
 void elementwise_modred(
-    AGetter get_a,
-    BGetter get_b,
+    const ModopInput<T>& a,
+    const ModopInput<T>& b,
     std::shared_ptr<DeviceTensor<T>>& result,
     CombineOp combine_op)
 {
-    const auto& out_shape = result->dims;
-    int64_t ndim = out_shape.size();
-
-    // Compute total size and strides (same as before)…
-    int64_t total = 1;
-    for (auto d : out_shape) total *= d;
-    std::vector<int64_t> strides(ndim,1);
-    for (int i = ndim-2; i>=0; --i)
-        strides[i] = strides[i+1] * out_shape[i+1];
-
-    #pragma omp parallel for
-    for (int64_t idx = 0; idx < total; ++idx) {
-        std::vector<int64_t> coord(ndim);
-        int64_t linear = idx;
-        for (int d = 0; d < ndim; ++d) {
-            coord[d]  = linear / strides[d];
-            linear   %= strides[d];
+    T* out = reinterpret_cast<T*>(result->data.get());
+    const StridedLoop<3> loop(result->dims,
+                              {StridedOperand(result->dims, result->strides), a.layout, b.layout});
+
+    loop.parallel_run([&](int64_t, const std::array<int64_t, 3>& offset,
+                          const std::array<int64_t, 3>& stride, int64_t count) {
+        T* r = out + offset[0];
+        const T* x = a.data + offset[1];
+        const T* y = b.data + offset[2];
+        for (int64_t j = 0; j < count; ++j)
+            r[j * stride[0]] = combine_op(x[j * stride[1]], y[j * stride[2]]);
+    });
+}
+
+// ---- Contiguous fast path ----
+//
+// When a, b (unless scalar) and result are contiguous with the same shape and p is a
+// scalar or a [k] vector along the last axis, the op runs over the flat buffers in chunks
+// of contiguous_chunk elements, through the AVX2 / AVX-512 kernels when available.
+
+// Dims equal to `dims` and row-major strides (size-1 dims may have any stride).
+inline bool is_dense(const StridedOperand& op, const std::vector<int64_t>& dims) {
+    if (op.ndim != static_cast<int64_t>(dims.size())) return false;
+    int64_t expected_stride = 1;
+    for (int64_t d = op.ndim - 1; d >= 0; --d) {
+        if (op.dims[d] != dims[d]) return false;
+        if (op.dims[d] == 1) continue;
+        if (op.strides[d] != expected_stride) return false;
+        expected_stride *= op.dims[d];
+    }
+    return true;
+}
+
+template <typename T, ModopKind Kind>
+void run_modop_contiguous(T* r, const T* a, const T* b, int64_t b_step, int64_t n,
+                          const ModulusTable<T>& table) {
+    const SimdLevel level = simd_level();
+    const int64_t chunks = (n + contiguous_chunk - 1) / contiguous_chunk;
+
+    #pragma omp parallel for schedule(static) if (n >= 32768)
+    for (int64_t c = 0; c < chunks; ++c) {
+        const int64_t s = c * contiguous_chunk;
+        run_modop_span<T, Kind>(level, r + s, a + s, b + s * b_step, b_step,
+                                std::min(contiguous_chunk, n - s), table, s % table.k);
+    }
+}
+
+// Runs the op on the fast path if the operands qualify; returns false otherwise.
+template <typename T, ModopKind Kind>
+bool try_modop_contiguous(const ModopInput<T>& a, const ModopInput<T>& b, const ModulusTable<T>& table,
+                          std::shared_ptr<DeviceTensor<T>>& result) {
+    const std::vector<int64_t>& dims = result->dims;
+    if (dims.empty() || (table.k != 1 && table.k != dims.back())) return false;
+    if (!is_dense(StridedOperand(dims, result->strides), dims) || !is_dense(a.layout, dims)) return false;
+    if (b.layout.ndim != 0 && !is_dense(b.layout, dims)) return false;
+
+    int64_t n = 1;
+    for (int64_t d : dims) n *= d;
+    if (n > 0) {
+        run_modop_contiguous<T, Kind>(reinterpret_cast<T*>(result->data.get()), a.data, b.data,
+                                      b.layout.ndim == 0 ? 0 : 1, n, table);
+    }
+    return true;
+}
+
+// Strided path with p replaced by the table's dense copy, so the element offset of p
+// also indexes its Barrett constants.
+template <typename T, ModopKind Kind>
+void run_modop_strided(const ModopInput<T>& a, const ModopInput<T>& b, const ModopInput<T>& p,
+                       const ModulusTable<T>& table, std::shared_ptr<DeviceTensor<T>>& result) {
+    const std::vector<int64_t> table_dims(p.layout.ndim, table.k);
+    const std::vector<int64_t> table_strides(p.layout.ndim, 1);
+    const SimdLevel level = simd_level();
+    T* out = reinterpret_cast<T*>(result->data.get());
+    const StridedLoop<4> loop(result->dims,
+                              {StridedOperand(result->dims, result->strides), a.layout, b.layout,
+                               StridedOperand(table_dims, table_strides)});
+
+    loop.parallel_run([&](int64_t, const std::array<int64_t, 4>& offset,
+                          const std::array<int64_t, 4>& stride, int64_t count) {
+        T* r = out + offset[0];
+        const T* x = a.data + offset[1];
+        const T* y = b.data + offset[2];
+        // A run along p's dim with dense a / result (e.g. b broadcast over the last axis)
+        // stays within the first k table entries, so it can take the contiguous kernels.
+        if (stride[0] == 1 && stride[1] == 1 && (stride[2] == 0 || stride[2] == 1) && stride[3] == 1) {
+            run_modop_span<T, Kind>(level, r, x, y, stride[2], count, table, offset[3]);
+            return;
+        }
+        const T* q = table.p.data() + offset[3];
+        const T* mu = table_mu<T, Kind>(table, offset[3]);
+        const T* log2p = table_log2p<T, Kind>(table, offset[3]);
+        // Local copies: with T = int64_t a store through r could alias `stride`.
+        const int64_t sr = stride[0], sx = stride[1], sy = stride[2], sq = stride[3];
+        for (int64_t j = 0; j < count; ++j) {
+            r[j * sr] = modop_element<T, Kind>(x[j * sx], y[j * sy], q[j * sq],
+                                               uses_mu(Kind) ? mu[j * sq] : 0,
+                                               Kind == ModopKind::mul ? log2p[j * sq] : 0);
+        }
+    });
+}
+
+template <typename T, ModopKind Kind>
+void run_modop_reduced(const ModopInput<T>& a, const ModopInput<T>& b, const ModopInput<T>& p,
+                       const ModulusTable<T>& table, std::shared_ptr<DeviceTensor<T>>& result) {
+    if (!try_modop_contiguous<T, Kind>(a, b, table, result)) {
+        run_modop_strided<T, Kind>(a, b, p, table, result);
+    }
+}
+
+template <typename T, ModopKind Kind>
+bool try_modop_reduced(const ModopInput<T>& a, const ModopInput<T>& b, const ModopInput<T>& p,
+                       std::shared_ptr<DeviceTensor<T>>& result) {
+    const auto table = get_modulus_table<T>(p);
+    if (!table || !(Kind == ModopKind::mul ? table->barrett : table->positive)) return false;
+    run_modop_reduced<T, Kind>(a, b, p, *table, result);
+    return true;
+}
+
+// ---- Montgomery form ----
+//
+// A tensor flagged `montgomery` holds x * R mod p (R = 2^bits(T)). The product of two such
+// tensors is their Montgomery product (REDC, no quotient estimate); a Montgomery tensor
+// times a plain operand is the ordinary Barrett product and stays in Montgomery form.
+// Sums need both operands in the same form; a plain scalar added to a Montgomery tensor
+// is converted once per modulus. Negation keeps the form.
+
+template <typename T>
+std::shared_ptr<const ModulusTable<T>> get_montgomery_table(const ModopInput<T>& p) {
+    const auto table = get_modulus_table<T>(p);
+    if (!table || !table->montgomery)
+        throw std::invalid_argument("Montgomery form needs a scalar or 1-D p of odd moduli below 2^(bits - 2).");
+    return table;
+}
+
+// A [k] operand of per-modulus values, broadcast along the last axis like p.
+template <typename T>
+struct ColumnOperand {
+    std::vector<int64_t> dims, strides{1};
+    ModopInput<T> input;
+
+    ColumnOperand(const ModulusTable<T>& table, const T* values)
+        : dims{table.k}, input{values, StridedOperand(dims, strides)} {}
+};
+
+// An operand of a Montgomery-form op, with a negative element replaced by a dense copy of
+// its residues in the result's shape. Nonnegative operands are used as they are: the
+// kernels' fallback for elements at or above p is the `%` of a nonnegative value, which is
+// already in [0, p), but a negative one would leave a negative result.
+template <typename T>
+struct ResidueOperand {
+    std::vector<int64_t> dims, strides;
+    std::vector<T> values;
+    ModopInput<T> input;
+
+    ResidueOperand(const ModopInput<T>& x, const ModulusTable<T>& table, const std::vector<int64_t>& result_dims)
+        : input(x) {
+        const std::vector<int64_t> x_dims(x.layout.dims, x.layout.dims + x.layout.ndim);
+        std::atomic<bool> negative{false};
+        StridedLoop<1>(x_dims, {x.layout}).parallel_run([&](int64_t, const std::array<int64_t, 1>& offset,
+                                                            const std::array<int64_t, 1>& stride, int64_t count) {
+            const T* v = x.data + offset[0];
+            for (int64_t j = 0; j < count; ++j) {
+                if (v[j * stride[0]] < 0) {
+                    negative.store(true, std::memory_order_relaxed);
+                    return;
+                }
+            }
+        });
+        if (!negative.load()) return;
+
+        // A Montgomery table's p is a scalar or a [k] vector along the last axis, so the
+        // modulus of dense element i is entry i % k.
+        dims = result_dims;
+        strides.assign(dims.size(), 1);
+        int64_t n = 1;
+        for (int64_t d = static_cast<int64_t>(dims.size()) - 1; d >= 0; --d) {
+            strides[d] = n;
+            n *= dims[d];
         }
-        T a_val = get_a(coord);
-        T b_val = get_b(coord);
-        result->at(coord) = combine_op(a_val, b_val);
+        values.resize(n);
+        const StridedLoop<2> loop(dims, {StridedOperand(dims, strides), x.layout});
+        loop.parallel_run([&](int64_t pos, const std::array<int64_t, 2>& offset,
+                              const std::array<int64_t, 2>& stride, int64_t count) {
+            T* r = values.data() + offset[0];
+            const T* v = x.data + offset[1];
+            for (int64_t j = 0; j < count; ++j)
+                r[j * stride[0]] = residue(v[j * stride[1]], table.p[(pos + j) % table.k]);
+        });
+        input = {values.data(), StridedOperand(dims, strides), x.montgomery};
+    }
+};
+
+template <typename T>
+void elementwise_modop_montgomery(
+    ModopKind kind,
+    const ModopInput<T>& a,
+    const ModopInput<T>& b,
+    const ModopInput<T>& p,
+    std::shared_ptr<DeviceTensor<T>>& result)
+{
+    const auto table = get_montgomery_table<T>(p);
+    if (kind == ModopKind::neg) {
+        run_modop_reduced<T, ModopKind::neg>(a, b, p, *table, result);
+        return;
     }
+    if (kind == ModopKind::mul && a.montgomery && b.montgomery) {
+        run_modop_reduced<T, ModopKind::montmul>(a, b, p, *table, result);
+        return;
+    }
+    const ResidueOperand<T> a_res(a, *table, result->dims);
+    if (kind == ModopKind::mul || a.montgomery == b.montgomery) {
+        const ResidueOperand<T> b_res(b, *table, result->dims);
+        if (kind == ModopKind::mul)
+            run_modop_reduced<T, ModopKind::mul>(a_res.input, b_res.input, p, *table, result);
+        else
+            run_modop_reduced<T, ModopKind::sum>(a_res.input, b_res.input, p, *table, result);
+        return;
+    }
+    if (b.layout.ndim != 0)
+        throw std::invalid_argument("modsum operands must both be in Montgomery form or both plain; "
+                                    "convert with to_montgomery / from_montgomery.");
+
+    std::vector<T> lifted(table->k);
+    for (int64_t t = 0; t < table->k; ++t) {
+        lifted[t] = modop_element<T, ModopKind::mul>(residue(*b.data, table->p[t]), table->r_mod_p[t],
+                                                    table->p[t], table->mu[t], table->log2p[t]);
+    }
+    const ColumnOperand<T> b_lifted(*table, lifted.data());
+    run_modop_reduced<T, ModopKind::sum>(a_res.input, b_lifted.input, p, *table, result);
 }
 
-template <typename T, typename AGetter, typename BGetter, typename PGetter, typename CombineOp>
+template <typename T, typename CombineOp>
 void elementwise_modop(
-    AGetter get_a,
-    BGetter get_b,
-    PGetter get_p,
+    ModopKind kind,
+    const ModopInput<T>& a,
+    const ModopInput<T>& b,
+    const ModopInput<T>& p,
     std::shared_ptr<DeviceTensor<T>>& result,
     CombineOp combine_op)
 {
-    const auto& out_shape = result->dims;
-    const int64_t ndim = out_shape.size();
+    if (a.montgomery || b.montgomery) {
+        elementwise_modop_montgomery<T>(kind, a, b, p, result);
+        result->montgomery = true;
+        return;
+    }
+    result->montgomery = false;
+    const bool reduced = kind == ModopKind::sum ? try_modop_reduced<T, ModopKind::sum>(a, b, p, result)
+                         : kind == ModopKind::neg ? try_modop_reduced<T, ModopKind::neg>(a, b, p, result)
+                                                  : try_modop_reduced<T, ModopKind::mul>(a, b, p, result);
+    if (reduced) return;
 
-    // Total number of elements
-    int64_t total = 1;
-    for (auto d : out_shape) total *= d;
+    T* out = reinterpret_cast<T*>(result->data.get());
+    const StridedLoop<4> loop(result->dims,
+                              {StridedOperand(result->dims, result->strides), a.layout, b.layout, p.layout});
 
-    // Precompute strides for linear → nd coord mapping
-    std::vector<int64_t> strides(ndim, 1);
-    for (int i = ndim - 2; i >= 0; --i) {
-        strides[i] = strides[i + 1] * out_shape[i + 1];
+    loop.parallel_run([&](int64_t, const std::array<int64_t, 4>& offset,
+                          const std::array<int64_t, 4>& stride, int64_t count) {
+        T* r = out + offset[0];
+        const T* x = a.data + offset[1];
+        const T* y = b.data + offset[2];
+        const T* q = p.data + offset[3];
+        for (int64_t j = 0; j < count; ++j)
+            r[j * stride[0]] = combine_op(x[j * stride[1]], y[j * stride[2]], q[j * stride[3]]);
+    });
+}
+
+// ---- Fused multiply-add ----
+//
+// result = (a * b + c) % p in one pass: for operands in [0, p) the Barrett product is
+// reduced once and c is folded in with a conditional subtract, otherwise the signed
+// double-width `%` of a * b + c (which cannot overflow T_DP<T>). Same paths as
+// modmul: contiguous kernels, then the strided loop over the modulus table, then the
+// generic loop for moduli outside the Barrett range or a p with more than one dim.
+
+template <typename T>
+inline T modmuladd_element(T x, T y, T z, T q, T mu, T log2p) {
+    using W = ShoupWord<T>;
+    if (static_cast<W>(x) < static_cast<W>(q) && static_cast<W>(y) < static_cast<W>(q) &&
+        static_cast<W>(z) < static_cast<W>(q)) {
+        const T prod = static_cast<T>(barrett_mul_word<T>(x, y, q, mu, static_cast<int>(log2p)));
+        const T sum = prod - q + z;  // in [-q, q), no overflow
+        return sum < 0 ? sum + q : sum;
     }
+    const T_DP<T> v = static_cast<T_DP<T>>(x) * y + z;
+    return static_cast<T>(v % static_cast<T_DP<T>>(q));
+}
+
+// run_modop_span for modmuladd, with c read at the same offsets as a.
+template <typename T>
+void run_modmuladd_span(SimdLevel level, T* r, const T* a, const T* b, int64_t b_step, const T* c,
+                        int64_t count, const ModulusTable<T>& table, int64_t t) {
+    using W = ShoupWord<T>;
+    const T* p = &table.p[t];
+    const T* mu = &table.mu[t];
+    const T* log2p = &table.log2p[t];
 
-    #pragma omp parallel for
-    for (int64_t idx = 0; idx < total; ++idx) {
-        // Compute multi-dimensional coordinate
-        std::vector<int64_t> coord(ndim);
-        int64_t linear = idx;
-        for (int d = 0; d < ndim; ++d) {
-            coord[d] = linear / strides[d];
-            linear %= strides[d];
+    int64_t done = 0;
+    if (level != SimdLevel::scalar) {
+        done = count / simd_lanes<T>(level) * simd_lanes<T>(level);
+        if (done > 0) {
+            LATTICA_SIMD_CALL(level, modmuladd_contiguous, reinterpret_cast<W*>(r),
+                              reinterpret_cast<const W*>(a), reinterpret_cast<const W*>(b), b_step,
+                              reinterpret_cast<const W*>(c), done, reinterpret_cast<const W*>(p),
+                              reinterpret_cast<const W*>(mu), reinterpret_cast<const W*>(log2p));
         }
+    }
+    for (int64_t i = done; i < count; ++i)
+        r[i] = modmuladd_element<T>(a[i], b[i * b_step], c[i], p[i], mu[i], log2p[i]);
+}
+
+template <typename T>
+bool try_modmuladd_contiguous(const ModopInput<T>& a, const ModopInput<T>& b, const ModopInput<T>& c,
+                              const ModulusTable<T>& table, std::shared_ptr<DeviceTensor<T>>& result) {
+    const std::vector<int64_t>& dims = result->dims;
+    if (dims.empty() || (table.k != 1 && table.k != dims.back())) return false;
+    if (!is_dense(StridedOperand(dims, result->strides), dims) || !is_dense(a.layout, dims) ||
+        !is_dense(c.layout, dims))
+        return false;
+    if (b.layout.ndim != 0 && !is_dense(b.layout, dims)) return false;
 
-        T a_val = get_a(coord);
-        T b_val = get_b(coord);
-        T p_val = get_p(coord);
-        result->at(coord) = combine_op(a_val, b_val, p_val);
+    int64_t n = 1;
+    for (int64_t d : dims) n *= d;
+    T* out = reinterpret_cast<T*>(result->data.get());
+    const int64_t b_step = b.layout.ndim == 0 ? 0 : 1;
+    const SimdLevel level = simd_level();
+    const int64_t chunks = (n + contiguous_chunk - 1) / contiguous_chunk;
+
+    #pragma omp parallel for schedule(static) if (n >= 32768)
+    for (int64_t ch = 0; ch < chunks; ++ch) {
+        const int64_t s = ch * contiguous_chunk;
+        run_modmuladd_span<T>(level, out + s, a.data + s, b.data + s * b_step, b_step, c.data + s,
+                              std::min(contiguous_chunk, n - s), table, s % table.k);
     }
+    return true;
+}
+
+template <typename T>
+void run_modmuladd_strided(const ModopInput<T>& a, const ModopInput<T>& b, const ModopInput<T>& c,
+                           const ModopInput<T>& p, const ModulusTable<T>& table,
+                           std::shared_ptr<DeviceTensor<T>>& result) {
+    const std::vector<int64_t> table_dims(p.layout.ndim, table.k);
+    const std::vector<int64_t> table_strides(p.layout.ndim, 1);
+    const SimdLevel level = simd_level();
+    T* out = reinterpret_cast<T*>(result->data.get());
+    const StridedLoop<5> loop(result->dims,
+                              {StridedOperand(result->dims, result->strides), a.layout, b.layout,
+                               c.layout, StridedOperand(table_dims, table_strides)});
+
+    loop.parallel_run([&](int64_t, const std::array<int64_t, 5>& offset,
+                          const std::array<int64_t, 5>& stride, int64_t count) {
+        T* r = out + offset[0];
+        const T* x = a.data + offset[1];
+        const T* y = b.data + offset[2];
+        const T* z = c.data + offset[3];
+        if (stride[0] == 1 && stride[1] == 1 && (stride[2] == 0 || stride[2] == 1) && stride[3] == 1 &&
+            stride[4] == 1) {
+            run_modmuladd_span<T>(level, r, x, y, stride[2], z, count, table, offset[4]);
+            return;
+        }
+        const T* q = table.p.data() + offset[4];
+        const T* mu = table.mu.data() + offset[4];
+        const T* log2p = table.log2p.data() + offset[4];
+        const int64_t sr = stride[0], sx = stride[1], sy = stride[2], sz = stride[3], sq = stride[4];
+        for (int64_t j = 0; j < count; ++j)
+            r[j * sr] = modmuladd_element<T>(x[j * sx], y[j * sy], z[j * sz], q[j * sq], mu[j * sq],
+                                             log2p[j * sq]);
+    });
 }
 
+// A Montgomery operand times a plain one is already in Montgomery form, so a * b + c only
+// needs c in the product's form; two Montgomery factors are left to modmul.
+template <typename T>
+void elementwise_modmuladd(
+    const ModopInput<T>& a,
+    const ModopInput<T>& b,
+    const ModopInput<T>& c,
+    const ModopInput<T>& p,
+    std::shared_ptr<DeviceTensor<T>>& result)
+{
+    const bool montgomery = a.montgomery || b.montgomery;
+    if (a.montgomery && b.montgomery)
+        throw std::invalid_argument("modmuladd takes at most one Montgomery-form factor; use modmul and modsum.");
+    if (c.montgomery != montgomery)
+        throw std::invalid_argument("c must be in Montgomery form exactly when a or b is.");
+    if (montgomery) {
+        const auto table = get_montgomery_table<T>(p);
+        const ResidueOperand<T> a_res(a, *table, result->dims), b_res(b, *table, result->dims),
+            c_res(c, *table, result->dims);
+        if (!try_modmuladd_contiguous<T>(a_res.input, b_res.input, c_res.input, *table, result))
+            run_modmuladd_strided<T>(a_res.input, b_res.input, c_res.input, p, *table, result);
+        result->montgomery = true;
+        return;
+    }
+    result->montgomery = false;
+
+    const auto table = get_modulus_table<T>(p);
+    if (table && table->barrett) {
+        if (!try_modmuladd_contiguous<T>(a, b, c, *table, result))
+            run_modmuladd_strided<T>(a, b, c, p, *table, result);
+        return;
+    }
+
+    T* out = reinterpret_cast<T*>(result->data.get());
+    const StridedLoop<5> loop(result->dims,
+                              {StridedOperand(result->dims, result->strides), a.layout, b.layout,
+                               c.layout, p.layout});
+
+    loop.parallel_run([&](int64_t, const std::array<int64_t, 5>& offset,
+                          const std::array<int64_t, 5>& stride, int64_t count) {
+        T* r = out + offset[0];
+        const T* x = a.data + offset[1];
+        const T* y = b.data + offset[2];
+        const T* z = c.data + offset[3];
+        const T* q = p.data + offset[4];
+        for (int64_t j = 0; j < count; ++j) {
+            const T_DP<T> v = static_cast<T_DP<T>>(x[j * stride[1]]) * y[j * stride[2]] + z[j * stride[3]];
+            r[j * stride[0]] = static_cast<T>(v % static_cast<T_DP<T>>(q[j * stride[4]]));
+        }
+    });
+}
 
 // ---- Wrapper Functions ----
 #define CHECK_DIMS_MATCH_LAST(tensor, result, label) \
@@ -105,7 +471,7 @@ void elementwise_modop(
         throw std::invalid_argument(std::string(label) + \
             " pointer must not be null.");
 
-#define DEFINE_MODULAR_ARITHMETIC_WRAPPER(OPNAME, OPERATOR) \
+#define DEFINE_MODULAR_ARITHMETIC_WRAPPER(OPNAME, KIND, OPERATOR) \
 template <typename T> \
 void OPNAME##_ttt( \
     const std::shared_ptr<DeviceTensor<T>>& a, \
@@ -116,9 +482,10 @@ void OPNAME##_ttt( \
     CHECK_DIMS_BROADCASTABLE(b, result, "b"); \
     CHECK_DIMS_MATCH_LAST(p, result, "p"); \
     elementwise_modop<T>( \
-        [a](const std::vector<int64_t>& coord) { return a->at_with_broadcast(coord); }, \
-        [b](const std::vector<int64_t>& coord) { return b->at_with_broadcast(coord); }, \
-        [p](const std::vector<int64_t>& coord) { return p->at_with_broadcast(coord); }, \
+        KIND, \
+        ModopInput<T>::tensor(a), \
+        ModopInput<T>::tensor(b), \
+        ModopInput<T>::tensor(p), \
         result, \
         [](T a, T b, T p) { \
             T_DP<T> tmp = OPERATOR; \
@@ -134,9 +501,10 @@ void OPNAME##_ttc( \
     CHECK_DIMS_BROADCASTABLE(a, result, "a"); \
     CHECK_DIMS_BROADCASTABLE(b, result, "b"); \
     elementwise_modop<T>( \
-        [a](const std::vector<int64_t>& coord) { return a->at_with_broadcast(coord); }, \
-        [b](const std::vector<int64_t>& coord) { return b->at_with_broadcast(coord); }, \
-        [&](const std::vector<int64_t>&) { return p_scalar; }, \
+        KIND, \
+        ModopInput<T>::tensor(a), \
+        ModopInput<T>::tensor(b), \
+        ModopInput<T>::scalar(p_scalar), \
         result, \
         [](T a, T b, T p) { \
             T_DP<T> tmp = OPERATOR; \
@@ -152,9 +520,10 @@ void OPNAME##_tct( \
     CHECK_DIMS_BROADCASTABLE(a, result, "a"); \
     CHECK_DIMS_MATCH_LAST(p, result, "p"); \
     elementwise_modop<T>( \
-        [a](const std::vector<int64_t>& coord) { return a->at_with_broadcast(coord); }, \
-        [&](const std::vector<int64_t>&) { return b_scalar; }, \
-        [p](const std::vector<int64_t>& coord) { return p->at_with_broadcast(coord); }, \
+        KIND, \
+        ModopInput<T>::tensor(a), \
+        ModopInput<T>::scalar(b_scalar), \
+        ModopInput<T>::tensor(p), \
         result, \
         [](T a, T b, T p) { \
             T_DP<T> tmp = OPERATOR; \
@@ -168,10 +537,11 @@ void OPNAME##_tcc( \
     T p_scalar, \
     std::shared_ptr<DeviceTensor<T>>& result) { \
     CHECK_DIMS_BROADCASTABLE(a, result, "a"); \
-    elementwise_modop<T>(  \
-        [a](const std::vector<int64_t>& coord) { return a->at_with_broadcast(coord); }, \
-        [&](const std::vector<int64_t>&) { return b_scalar; }, \
-        [&](const std::vector<int64_t>&) { return p_scalar; }, \
+    elementwise_modop<T>( \
+        KIND, \
+        ModopInput<T>::tensor(a), \
+        ModopInput<T>::scalar(b_scalar), \
+        ModopInput<T>::scalar(p_scalar), \
         result, \
         [](T a, T b, T p) { \
             T_DP<T> tmp = OPERATOR; \
@@ -185,6 +555,11 @@ void OPNAME##_tcc( \
         throw std::invalid_argument(std::string(label) + \
             " must have exactly the same shape as result."); \
 
+#define CHECK_NOT_MONTGOMERY(tensor, label) \
+    if ((tensor)->montgomery) \
+        throw std::invalid_argument(std::string(label) + \
+            " is in Montgomery form; convert it with from_montgomery first.");
+
 #define DEFINE_SIMPLE_MOD_WRAPPER(OPNAME) \
 template <typename T> \
 void OPNAME##_tt( \
@@ -196,9 +571,12 @@ void OPNAME##_tt( \
     CHECK_NOT_NULL(b, "b"); \
     CHECK_SAME_DIMS(a, result, "a"); \
     CHECK_SAME_DIMS(b, result, "b"); \
+    CHECK_NOT_MONTGOMERY(a, "a"); \
+    CHECK_NOT_MONTGOMERY(b, "b"); \
+    result->montgomery = false; \
     elementwise_modred<T>( \
-        [a](auto& coord) { return a->at(coord); }, \
-        [b](auto& coord) { return b->at(coord); }, \
+        ModopInput<T>::tensor(a), \
+        ModopInput<T>::tensor(b), \
         result, \
         [](T a, T b) { return static_cast<T>(a % b); } \
     ); \
@@ -211,9 +589,12 @@ void OPNAME##_tc( \
 { \
     CHECK_NOT_NULL(a, "a"); \
     CHECK_SAME_DIMS(a, result, "a"); \
+    CHECK_NOT_MONTGOMERY(a, "a"); \
+    result->montgomery = false; \
+    const T b_value = static_cast<T>(b_scalar); \
     elementwise_modred<T>( \
-        [a](auto& coord) { return a->at(coord); }, \
-        [&](auto&) { return static_cast<T>(b_scalar); }, \
+        ModopInput<T>::tensor(a), \
+        ModopInput<T>::scalar(b_value), \
         result, \
         [](T a, T b) { return static_cast<T>(a % b); } \
     ); \
@@ -226,19 +607,137 @@ void OPNAME##_ct( \
 { \
     CHECK_NOT_NULL(b, "b"); \
     CHECK_SAME_DIMS(b, result, "b"); \
+    CHECK_NOT_MONTGOMERY(b, "b"); \
+    result->montgomery = false; \
+    const T a_value = static_cast<T>(a_scalar); \
     elementwise_modred<T>( \
-        [&](auto&)      { return static_cast<T>(a_scalar); }, \
-        [b](auto& coord) { return b->at(coord); }, \
+        ModopInput<T>::scalar(a_value), \
+        ModopInput<T>::tensor(b), \
         result, \
         [](T a, T b) { return static_cast<T>(a % b); } \
     ); \
 }
 
 
-DEFINE_MODULAR_ARITHMETIC_WRAPPER(modsum, static_cast<T_DP<T>>(a) + static_cast<T_DP<T>>(b))
-DEFINE_MODULAR_ARITHMETIC_WRAPPER(modmul, static_cast<T_DP<T>>(a) * static_cast<T_DP<T>>(b))
+DEFINE_MODULAR_ARITHMETIC_WRAPPER(modsum, ModopKind::sum, static_cast<T_DP<T>>(a) + static_cast<T_DP<T>>(b))
+DEFINE_MODULAR_ARITHMETIC_WRAPPER(modmul, ModopKind::mul, static_cast<T_DP<T>>(a) * static_cast<T_DP<T>>(b))
 DEFINE_SIMPLE_MOD_WRAPPER(mod)
 
+template <typename T>
+void modmuladd_ttt(
+    const std::shared_ptr<DeviceTensor<T>>& a,
+    const std::shared_ptr<DeviceTensor<T>>& b,
+    const std::shared_ptr<DeviceTensor<T>>& c,
+    const std::shared_ptr<DeviceTensor<T>>& p,
+    std::shared_ptr<DeviceTensor<T>>& result) {
+    CHECK_DIMS_BROADCASTABLE(a, result, "a");
+    CHECK_DIMS_BROADCASTABLE(b, result, "b");
+    CHECK_DIMS_BROADCASTABLE(c, result, "c");
+    CHECK_DIMS_MATCH_LAST(p, result, "p");
+    elementwise_modmuladd<T>(ModopInput<T>::tensor(a), ModopInput<T>::tensor(b),
+                             ModopInput<T>::tensor(c), ModopInput<T>::tensor(p), result);
+}
+
+template <typename T>
+void modmuladd_ttc(
+    const std::shared_ptr<DeviceTensor<T>>& a,
+    const std::shared_ptr<DeviceTensor<T>>& b,
+    const std::shared_ptr<DeviceTensor<T>>& c,
+    T p_scalar,
+    std::shared_ptr<DeviceTensor<T>>& result) {
+    CHECK_DIMS_BROADCASTABLE(a, result, "a");
+    CHECK_DIMS_BROADCASTABLE(b, result, "b");
+    CHECK_DIMS_BROADCASTABLE(c, result, "c");
+    elementwise_modmuladd<T>(ModopInput<T>::tensor(a), ModopInput<T>::tensor(b),
+                             ModopInput<T>::tensor(c), ModopInput<T>::scalar(p_scalar), result);
+}
+
+template <typename T>
+void modmuladd_tct(
+    const std::shared_ptr<DeviceTensor<T>>& a,
+    T b_scalar,
+    const std::shared_ptr<DeviceTensor<T>>& c,
+    const std::shared_ptr<DeviceTensor<T>>& p,
+    std::shared_ptr<DeviceTensor<T>>& result) {
+    CHECK_DIMS_BROADCASTABLE(a, result, "a");
+    CHECK_DIMS_BROADCASTABLE(c, result, "c");
+    CHECK_DIMS_MATCH_LAST(p, result, "p");
+    elementwise_modmuladd<T>(ModopInput<T>::tensor(a), ModopInput<T>::scalar(b_scalar),
+                             ModopInput<T>::tensor(c), ModopInput<T>::tensor(p), result);
+}
+
+template <typename T>
+void modmuladd_tcc(
+    const std::shared_ptr<DeviceTensor<T>>& a,
+    T b_scalar,
+    const std::shared_ptr<DeviceTensor<T>>& c,
+    T p_scalar,
+    std::shared_ptr<DeviceTensor<T>>& result) {
+    CHECK_DIMS_BROADCASTABLE(a, result, "a");
+    CHECK_DIMS_BROADCASTABLE(c, result, "c");
+    elementwise_modmuladd<T>(ModopInput<T>::tensor(a), ModopInput<T>::scalar(b_scalar),
+                             ModopInput<T>::tensor(c), ModopInput<T>::scalar(p_scalar), result);
+}
+
+template <typename T>
+void modneg_tt(
+    const std::shared_ptr<DeviceTensor<T>>& a,
+    const std::shared_ptr<DeviceTensor<T>>& p,
+    std::shared_ptr<DeviceTensor<T>>& result) {
+    CHECK_DIMS_BROADCASTABLE(a, result, "a");
+    CHECK_DIMS_MATCH_LAST(p, result, "p");
+    const T zero = 0;
+    elementwise_modop<T>(ModopKind::neg, ModopInput<T>::tensor(a), ModopInput<T>::scalar(zero),
+                         ModopInput<T>::tensor(p), result, [](T a, T, T p) {
+        return residue<T_DP<T>>(-static_cast<T_DP<T>>(a), p);
+    });
+}
+
+template <typename T>
+void modneg_tc(
+    const std::shared_ptr<DeviceTensor<T>>& a,
+    T p_scalar,
+    std::shared_ptr<DeviceTensor<T>>& result) {
+    CHECK_DIMS_BROADCASTABLE(a, result, "a");
+    const T zero = 0;
+    elementwise_modop<T>(ModopKind::neg, ModopInput<T>::tensor(a), ModopInput<T>::scalar(zero),
+                         ModopInput<T>::scalar(p_scalar), result, [](T a, T, T p) {
+        return residue<T_DP<T>>(-static_cast<T_DP<T>>(a), p);
+    });
+}
+
+template <typename T>
+void to_montgomery(
+    const std::shared_ptr<DeviceTensor<T>>& a,
+    const std::shared_ptr<DeviceTensor<T>>& p,
+    std::shared_ptr<DeviceTensor<T>>& result) {
+    CHECK_DIMS_BROADCASTABLE(a, result, "a");
+    CHECK_DIMS_MATCH_LAST(p, result, "p");
+    CHECK_NOT_MONTGOMERY(a, "a");
+    const ModopInput<T> p_input = ModopInput<T>::tensor(p);
+    const auto table = get_montgomery_table<T>(p_input);
+    const ColumnOperand<T> r_mod_p(*table, table->r_mod_p.data());
+    const ResidueOperand<T> a_res(ModopInput<T>::tensor(a), *table, result->dims);
+    run_modop_reduced<T, ModopKind::mul>(a_res.input, r_mod_p.input, p_input, *table, result);
+    result->montgomery = true;
+}
+
+template <typename T>
+void from_montgomery(
+    const std::shared_ptr<DeviceTensor<T>>& a,
+    const std::shared_ptr<DeviceTensor<T>>& p,
+    std::shared_ptr<DeviceTensor<T>>& result) {
+    CHECK_DIMS_BROADCASTABLE(a, result, "a");
+    CHECK_DIMS_MATCH_LAST(p, result, "p");
+    if (!a->montgomery) throw std::invalid_argument("a is not in Montgomery form.");
+    const ModopInput<T> p_input = ModopInput<T>::tensor(p);
+    const auto table = get_montgomery_table<T>(p_input);
+    const T one = 1;
+    run_modop_reduced<T, ModopKind::montmul>(ModopInput<T>::tensor(a), ModopInput<T>::scalar(one), p_input,
+                                             *table, result);
+    result->montgomery = false;
+}
+
 // Explicit instantiations
 #define INSTANTIATE_ALL(T) \
 template void modsum_ttt<T>(const std::shared_ptr<DeviceTensor<T>>&, const std::shared_ptr<DeviceTensor<T>>&, const std::shared_ptr<DeviceTensor<T>>&, std::shared_ptr<DeviceTensor<T>>&); \
@@ -252,6 +751,14 @@ template void modmul_tcc<T>(const std::shared_ptr<DeviceTensor<T>>&, T, T, std::
 template void mod_tt<T>(const std::shared_ptr<DeviceTensor<T>>&, const std::shared_ptr<DeviceTensor<T>>&, std::shared_ptr<DeviceTensor<T>>&); \
 template void mod_tc<T>(const std::shared_ptr<DeviceTensor<T>>&, int64_t, std::shared_ptr<DeviceTensor<T>>&); \
 template void mod_ct<T>(int64_t, const std::shared_ptr<DeviceTensor<T>>&, std::shared_ptr<DeviceTensor<T>>&); \
+template void modmuladd_ttt<T>(const std::shared_ptr<DeviceTensor<T>>&, const std::shared_ptr<DeviceTensor<T>>&, const std::shared_ptr<DeviceTensor<T>>&, const std::shared_ptr<DeviceTensor<T>>&, std::shared_ptr<DeviceTensor<T>>&); \
+template void modmuladd_ttc<T>(const std::shared_ptr<DeviceTensor<T>>&, const std::shared_ptr<DeviceTensor<T>>&, const std::shared_ptr<DeviceTensor<T>>&, T, std::shared_ptr<DeviceTensor<T>>&); \
+template void modmuladd_tct<T>(const std::shared_ptr<DeviceTensor<T>>&, T, const std::shared_ptr<DeviceTensor<T>>&, const std::shared_ptr<DeviceTensor<T>>&, std::shared_ptr<DeviceTensor<T>>&); \
+template void modmuladd_tcc<T>(const std::shared_ptr<DeviceTensor<T>>&, T, const std::shared_ptr<DeviceTensor<T>>&, T, std::shared_ptr<DeviceTensor<T>>&); \
+template void modneg_tt<T>(const std::shared_ptr<DeviceTensor<T>>&, const std::shared_ptr<DeviceTensor<T>>&, std::shared_ptr<DeviceTensor<T>>&); \
+template void modneg_tc<T>(const std::shared_ptr<DeviceTensor<T>>&, T, std::shared_ptr<DeviceTensor<T>>&); \
+template void to_montgomery<T>(const std::shared_ptr<DeviceTensor<T>>&, const std::shared_ptr<DeviceTensor<T>>&, std::shared_ptr<DeviceTensor<T>>&); \
+template void from_montgomery<T>(const std::shared_ptr<DeviceTensor<T>>&, const std::shared_ptr<DeviceTensor<T>>&, std::shared_ptr<DeviceTensor<T>>&); \
 
 INSTANTIATE_ALL(int32_t)
 INSTANTIATE_ALL(int64_t)
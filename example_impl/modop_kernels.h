@@ -0,0 +1,279 @@
+#ifndef MODOP_KERNELS_H
+#define MODOP_KERNELS_H
+
+#include "device_memory_impl.h"
+#include "mod_arith.h"
+#include "modulus_registry.h"
+#include "simd_dispatch.h"
+#include "simd_kernels.h"
+#include "strided_loop.h"
+#include "typing.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+/**
+ * @brief Modulus tables and span kernels shared by the elementwise modular ops
+ *        (modop_impl.cpp) and fused expressions (fused_modop_impl.cpp).
+ */
+
+namespace lattica_hw_api {
+
+// One input of an elementwise op: a tensor, broadcast against the result, or a scalar
+// (read through a zero-stride operand, so it must outlive the call). Scalars are never in
+// Montgomery form.
+template <typename T>
+struct ModopInput {
+    const T* data;
+    StridedOperand layout;
+    bool montgomery = false;
+
+    static ModopInput tensor(const std::shared_ptr<DeviceTensor<T>>& t) {
+        return {reinterpret_cast<const T*>(t->data.get()), StridedOperand(t->dims, t->strides),
+                t->montgomery};
+    }
+    static ModopInput scalar(const T& value) {
+        return {&value, StridedOperand()};
+    }
+};
+
+// montmul is the Montgomery product x * y * R^-1 of two Montgomery-form operands; neg is
+// the negation -x, which ignores y.
+enum class ModopKind { sum, mul, montmul, neg };
+
+// Whether Kind reads a per-modulus constant from the mu slot of a table entry.
+constexpr bool uses_mu(ModopKind kind) {
+    return kind == ModopKind::mul || kind == ModopKind::montmul;
+}
+
+// ---- Per-modulus precomputation ----
+//
+// For a scalar or 1-D p the moduli are read once per call and matched against a small
+// cache of ModulusTables, so the Barrett constants of a modulus set are derived once and
+// reused by every later modmul/modsum over the same moduli.
+
+constexpr int64_t contiguous_chunk = 1024;  // multiple of max_simd_lanes
+
+// The moduli of a scalar or 1-D p with their Barrett constants (when every modulus fits
+// Barrett), repeated cyclically over k + contiguous_chunk - 1 entries: the first k entries
+// are p itself, and a run of flat elements starting at index s reads one contiguous
+// stretch from entry s % k.
+template <typename T>
+struct ModulusTable {
+    int64_t k = 0;
+    bool barrett = false;   // every modulus accepted by fits_barrett()
+    bool positive = false;  // every modulus >= 1
+    bool montgomery = false;  // every modulus accepted by fits_montgomery()
+    std::vector<T> p, mu, log2p;
+    std::vector<T> p_inv;    // cyclic like p, when montgomery
+    std::vector<T> r_mod_p;  // R mod p for each of the k moduli, when montgomery
+    // Per modulus kernels specialized on p (modulus_registry.h); empty unless every
+    // modulus is registered.
+    std::vector<FixedModopKernel<T>> fixed_sum, fixed_mul;
+};
+
+template <typename T>
+std::shared_ptr<const ModulusTable<T>> build_modulus_table(std::vector<T> p_values) {
+    auto table = std::make_shared<ModulusTable<T>>();
+    const int64_t k = static_cast<int64_t>(p_values.size());
+    table->k = k;
+    table->barrett = std::all_of(p_values.begin(), p_values.end(), fits_barrett<T>);
+    table->positive = std::all_of(p_values.begin(), p_values.end(), [](T q) { return q >= 1; });
+    table->montgomery = std::all_of(p_values.begin(), p_values.end(), fits_montgomery<T>);
+
+    const int64_t stride = k + contiguous_chunk - 1;
+    table->p.resize(stride);
+    if (table->barrett) {
+        table->mu.resize(stride);
+        table->log2p.resize(stride);
+    }
+    if (table->montgomery) {
+        table->p_inv.resize(stride);
+        table->r_mod_p.resize(k);
+    }
+    for (int64_t t = 0; t < k; ++t) {
+        table->fixed_sum.push_back(find_fixed_modop_kernel<T, false>(p_values[t]));
+        table->fixed_mul.push_back(find_fixed_modop_kernel<T, true>(p_values[t]));
+        if (!table->fixed_sum.back()) {
+            table->fixed_sum.clear();
+            table->fixed_mul.clear();
+            break;
+        }
+    }
+    for (int64_t t = 0; t < k; ++t) {
+        for (int64_t q = t; q < stride; q += k) table->p[q] = p_values[t];
+        if (table->barrett) {
+            const BarrettReducer<T> red = make_barrett_reducer<T>(p_values[t]);
+            for (int64_t q = t; q < stride; q += k) {
+                table->mu[q] = red.mu;
+                table->log2p[q] = static_cast<T>(red.n - 1);
+            }
+        }
+        if (table->montgomery) {
+            const MontgomeryConstants<T> mont = make_montgomery_constants<T>(p_values[t]);
+            for (int64_t q = t; q < stride; q += k) table->p_inv[q] = static_cast<T>(mont.p_inv);
+            table->r_mod_p[t] = static_cast<T>(mont.r_mod_p);
+        }
+    }
+    return table;
+}
+
+// Matched on content like the NTT twiddle cache, so a rewritten p buffer never hits a
+// stale entry. Returns nullptr for a p with more than one dim.
+template <typename T>
+std::shared_ptr<const ModulusTable<T>> get_modulus_table(const ModopInput<T>& p) {
+    constexpr size_t max_entries = 16;
+    static std::mutex cache_mutex;
+    static std::deque<std::shared_ptr<const ModulusTable<T>>> cache;
+
+    if (p.layout.ndim > 1) return nullptr;
+    const int64_t k = p.layout.ndim == 0 ? 1 : p.layout.dims[0];
+    const int64_t stride = p.layout.ndim == 0 ? 0 : p.layout.strides[0];
+    std::vector<T> p_values(k);
+    for (int64_t t = 0; t < k; ++t) p_values[t] = p.data[t * stride];
+
+    {
+        std::lock_guard<std::mutex> lock(cache_mutex);
+        for (const auto& entry : cache) {
+            if (entry->k == k && std::equal(p_values.begin(), p_values.end(), entry->p.begin()))
+                return entry;
+        }
+    }
+
+    auto entry = build_modulus_table<T>(std::move(p_values));
+
+    std::lock_guard<std::mutex> lock(cache_mutex);
+    if (cache.size() == max_entries) cache.pop_front();
+    cache.push_back(entry);
+    return entry;
+}
+
+// x mod q in [0, q).
+template <typename T>
+inline T residue(T x, T q) {
+    const T r = x % q;
+    return r < 0 ? r + q : r;
+}
+
+// The constants modop_element reads for Kind from a table entry: Barrett mu / log2p for
+// mul, p_inv (in the mu slot) for montmul, none for sum and neg.
+template <typename T, ModopKind Kind>
+const T* table_mu(const ModulusTable<T>& table, int64_t t) {
+    return Kind == ModopKind::mul ? &table.mu[t] : Kind == ModopKind::montmul ? &table.p_inv[t] : nullptr;
+}
+
+template <typename T, ModopKind Kind>
+const T* table_log2p(const ModulusTable<T>& table, int64_t t) {
+    return Kind == ModopKind::mul ? &table.log2p[t] : nullptr;
+}
+
+// One element with modulus q: add + conditional subtract, Barrett multiply or q - x for
+// operands in [0, q), the generic path's signed double-width `%` otherwise. The Montgomery
+// product and the negation reduce out-of-range operands to residues instead.
+template <typename T, ModopKind Kind>
+inline T modop_element(T x, T y, T q, T mu, T log2p) {
+    using W = ShoupWord<T>;
+    if (Kind == ModopKind::montmul) {
+        if (static_cast<W>(x) >= static_cast<W>(q)) x = residue(x, q);
+        if (static_cast<W>(y) >= static_cast<W>(q)) y = residue(y, q);
+        return static_cast<T>(montgomery_mul_word<T>(x, y, q, mu));
+    }
+    if (Kind == ModopKind::neg) {
+        if (static_cast<W>(x) < static_cast<W>(q)) return x == 0 ? 0 : q - x;
+        const T_DP<T> v = -static_cast<T_DP<T>>(x) % static_cast<T_DP<T>>(q);
+        return static_cast<T>(v < 0 ? v + q : v);
+    }
+    if (static_cast<W>(x) < static_cast<W>(q) && static_cast<W>(y) < static_cast<W>(q)) {
+        if (Kind == ModopKind::sum) {
+            const T diff = x - q + y;  // in [-q, q), no overflow
+            return diff < 0 ? diff + q : diff;
+        }
+        return static_cast<T>(barrett_mul_word<T>(x, y, q, mu, static_cast<int>(log2p)));
+    }
+    const T_DP<T> v = Kind == ModopKind::sum ? static_cast<T_DP<T>>(x) + y
+                                             : static_cast<T_DP<T>>(x) * y;
+    return static_cast<T>(v % static_cast<T_DP<T>>(q));
+}
+
+// ---- Span kernels ----
+//
+// A span is a run of consecutive elements with dense operands (b may be a broadcast
+// scalar) whose moduli are consecutive ModulusTable entries.
+
+// Scalar counterpart of the simd_kernels.h contiguous modop kernels.
+template <typename T, ModopKind Kind>
+void modop_contiguous_scalar(T* r, const T* a, const T* b, int64_t b_step, int64_t count,
+                             const T* p, const T* mu, const T* log2p) {
+    for (int64_t i = 0; i < count; ++i) {
+        r[i] = modop_element<T, Kind>(a[i], b[i * b_step], p[i], uses_mu(Kind) ? mu[i] : 0,
+                                      Kind == ModopKind::mul ? log2p[i] : 0);
+    }
+}
+
+// `count` consecutive elements whose moduli are all registered, the first one using
+// modulus `column`: one specialized kernel call per modulus, over every k-th element.
+template <typename T, ModopKind Kind>
+void run_modop_fixed(T* r, const T* a, const T* b, int64_t b_step, int64_t count,
+                     const ModulusTable<T>& table, int64_t column) {
+    const int64_t k = table.k;
+    for (int64_t c = 0; c < std::min(k, count); ++c) {
+        const int64_t t = (column + c) % k;
+        const FixedModopKernel<T> kernel = Kind == ModopKind::mul ? table.fixed_mul[t] : table.fixed_sum[t];
+        kernel(r + c, a + c, b + c * b_step, b_step * k, (count - c + k - 1) / k, k);
+    }
+}
+
+// The specialized kernels are scalar: they beat the scalar runtime-modulus loop (int32
+// modmul by 2x, int64 by ~15%) but not the AVX2 / AVX-512 kernels.
+inline bool prefer_fixed_moduli(SimdLevel level) {
+    return level == SimdLevel::scalar;
+}
+
+// `count` consecutive elements (at most table.k + contiguous_chunk - 1 - t, t being the
+// table entry of the first one): specialized kernels when the moduli are registered, else
+// vector kernels for whole vectors and scalar for the rest.
+template <typename T, ModopKind Kind>
+void run_modop_span(SimdLevel level, T* r, const T* a, const T* b, int64_t b_step, int64_t count,
+                    const ModulusTable<T>& table, int64_t t) {
+    using W = ShoupWord<T>;
+    if ((Kind == ModopKind::sum || Kind == ModopKind::mul) && !table.fixed_sum.empty() &&
+        prefer_fixed_moduli(level)) {
+        run_modop_fixed<T, Kind>(r, a, b, b_step, count, table, t % table.k);
+        return;
+    }
+    const T* p = &table.p[t];
+    const T* mu = table_mu<T, Kind>(table, t);
+    const T* log2p = table_log2p<T, Kind>(table, t);
+
+    int64_t done = 0;
+    if (level != SimdLevel::scalar) {
+        done = count / simd_lanes<T>(level) * simd_lanes<T>(level);
+        if (done > 0) {
+            W* rw = reinterpret_cast<W*>(r);
+            const W* aw = reinterpret_cast<const W*>(a);
+            const W* bw = reinterpret_cast<const W*>(b);
+            const W* pw = reinterpret_cast<const W*>(p);
+            if (Kind == ModopKind::sum) {
+                LATTICA_SIMD_CALL(level, modsum_contiguous, rw, aw, bw, b_step, done, pw);
+            } else if (Kind == ModopKind::neg) {
+                LATTICA_SIMD_CALL(level, modneg_contiguous, rw, aw, done, pw);
+            } else if (Kind == ModopKind::montmul) {
+                LATTICA_SIMD_CALL(level, montmul_contiguous, rw, aw, bw, b_step, done, pw,
+                                  reinterpret_cast<const W*>(mu));
+            } else {
+                LATTICA_SIMD_CALL(level, modmul_contiguous, rw, aw, bw, b_step, done, pw,
+                                  reinterpret_cast<const W*>(mu), reinterpret_cast<const W*>(log2p));
+            }
+        }
+    }
+    modop_contiguous_scalar<T, Kind>(r + done, a + done, b + done * b_step, b_step, count - done,
+                                     p + done, mu ? mu + done : nullptr, log2p ? log2p + done : nullptr);
+}
+
+} // namespace lattica_hw_api
+
+#endif // MODOP_KERNELS_H
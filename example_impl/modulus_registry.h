@@ -0,0 +1,120 @@
+#ifndef MODULUS_REGISTRY_H
+#define MODULUS_REGISTRY_H
+
+#include "mod_arith.h"
+#include "typing.h"
+
+#include <cstdint>
+#include <iterator>
+#include <utility>
+
+/**
+ * @brief Moduli known at compile time, with modop kernels specialized on each of them.
+ *
+ * A deployment that runs on a small fixed set of NTT-friendly primes lists them here, or
+ * overrides the lists at build time with -DLATTICA_FIXED_MODULI_32=p0,p1,... and
+ * -DLATTICA_FIXED_MODULI_64=p0,p1,... (each list non-empty). Every listed prime gets
+ * modsum / modmul kernels instantiated with p as a template argument, so the reduction
+ * works on immediates: the Barrett constants and shifts for int64, and a `%` by a
+ * constant that the compiler strength-reduces for int32.
+ *
+ * modop_impl.cpp resolves moduli against the registry once per ModulusTable and keeps the
+ * runtime-modulus kernels as the fallback for anything not listed.
+ */
+
+#ifndef LATTICA_FIXED_MODULI_32
+#define LATTICA_FIXED_MODULI_32 1073479681, 1071513601, 1070727169, 1068236801
+#endif
+
+#ifndef LATTICA_FIXED_MODULI_64
+#define LATTICA_FIXED_MODULI_64 \
+    1152921504606584833, 1152921504598720513, 1152921504597016577, 1152921504595968001
+#endif
+
+namespace lattica_hw_api {
+
+template <typename T>
+struct FixedModuli;
+
+template <>
+struct FixedModuli<int32_t> {
+    static constexpr int32_t values[] = {LATTICA_FIXED_MODULI_32};
+};
+
+template <>
+struct FixedModuli<int64_t> {
+    static constexpr int64_t values[] = {LATTICA_FIXED_MODULI_64};
+};
+
+/**
+ * @brief modop's elementwise add / multiply for the compile-time modulus P: the fast
+ *        reduction for operands in [0, P), the signed double-width `%` otherwise.
+ */
+template <typename T, T P>
+struct FixedModulus {
+    static_assert(fits_barrett(P), "registered moduli must satisfy fits_barrett()");
+
+    using word = ShoupWord<T>;
+    using dword = typename ShoupTypes<T>::dword;
+
+    static constexpr int log2p = [] {
+        int n = 0;
+        while ((P >> n) != 0) ++n;
+        return n - 1;
+    }();
+    static constexpr word mu = static_cast<word>((static_cast<dword>(1) << (2 * (log2p + 1))) / P);
+
+    static bool in_range(T x) { return static_cast<word>(x) < static_cast<word>(P); }
+
+    static T add(T x, T y) {
+        if (in_range(x) && in_range(y)) {
+            const T diff = x - P + y;  // in [-P, P)
+            return diff + (P & (diff >> (sizeof(T) * 8 - 1)));
+        }
+        return static_cast<T>((static_cast<T_DP<T>>(x) + y) % P);
+    }
+
+    static T mul(T x, T y) {
+        if (in_range(x) && in_range(y)) {
+            if (sizeof(T) == 4) {
+                return static_cast<T>(static_cast<dword>(static_cast<word>(x)) * static_cast<word>(y) % P);
+            }
+            return static_cast<T>(barrett_mul_word<T>(x, y, P, mu, log2p));
+        }
+        return static_cast<T>(static_cast<T_DP<T>>(x) * y % P);
+    }
+};
+
+/**
+ * @brief r[i * step] = a[i * step] + / * b[i * b_step] mod P for i < count.
+ */
+template <typename T, T P, bool Mul>
+void fixed_modop_kernel(T* r, const T* a, const T* b, int64_t b_step, int64_t count, int64_t step) {
+    for (int64_t i = 0; i < count; ++i) {
+        r[i * step] = Mul ? FixedModulus<T, P>::mul(a[i * step], b[i * b_step])
+                          : FixedModulus<T, P>::add(a[i * step], b[i * b_step]);
+    }
+}
+
+template <typename T>
+using FixedModopKernel = void (*)(T*, const T*, const T*, int64_t, int64_t, int64_t);
+
+template <typename T, bool Mul, size_t... I>
+FixedModopKernel<T> find_fixed_modop_kernel(T p, std::index_sequence<I...>) {
+    FixedModopKernel<T> kernel = nullptr;
+    ((p == FixedModuli<T>::values[I] ? (void)(kernel = &fixed_modop_kernel<T, FixedModuli<T>::values[I], Mul>)
+                                     : (void)0), ...);
+    return kernel;
+}
+
+/**
+ * @brief The kernel specialized on p, or nullptr if p is not in the registry.
+ */
+template <typename T, bool Mul>
+FixedModopKernel<T> find_fixed_modop_kernel(T p) {
+    return find_fixed_modop_kernel<T, Mul>(p, std::make_index_sequence<std::size(FixedModuli<T>::values)>());
+}
+
+} // namespace lattica_hw_api
+
+#endif // MODULUS_REGISTRY_H
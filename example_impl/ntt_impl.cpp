@@ -1,9 +1,16 @@
 #include "device_memory_impl.h"
 #include "ntt.h"
 #include "typing.h"
+#include "mod_arith.h"
+#include "simd_dispatch.h"
+#include "simd_kernels.h"
 
 #include <stdexcept>
 #include <vector>
+#include <deque>
+#include <mutex>
+#include <algorithm>
+#include <atomic>
 #include <iostream>
 #include <omp.h>
 
@@ -11,6 +18,8 @@ namespace lattica_hw_api {
 
 namespace {
 
+std::atomic<int64_t> four_step_threshold{int64_t(1) << 13};
+
 // Validate and extract dimensions from a [l, m, r, k] tensor
 template <typename T>
 void validate_ntt_inputs(
@@ -35,84 +44,841 @@ void validate_ntt_inputs(
     if (p->dims.size() != 1 || p->dims[0] != k)
         throw std::invalid_argument("Tensor 'p' must have shape [k].");
 
-    if (perm->dims.size() != 1 || perm->dims[0] != m)
+    if (perm && (perm->dims.size() != 1 || perm->dims[0] != m))
         throw std::invalid_argument("Tensor 'perm' must have shape [m].");
 
     if (twiddles->dims.size() != 2 || twiddles->dims[0] != k || twiddles->dims[1] != m)
         throw std::invalid_argument("Tensor 'twiddles' must have shape [k, m].");
 }
 
+// Moduli below lazy_modulus_bound take the Shoup kernels; wider ones use plain division.
 template <typename T>
-void apply_permutation(
-    const std::shared_ptr<DeviceTensor<T>>& perm,
-    std::shared_ptr<DeviceTensor<T>>& result,
-    int64_t l, int64_t r, int64_t k, int64_t m
+bool use_lazy_shoup(T mod) {
+    return mod > 1 && static_cast<ShoupWord<T>>(mod) < lazy_modulus_bound<T>();
+}
+
+// A [k, m] twiddle table together with the Shoup companion of every entry.
+template <typename T>
+struct ShoupTwiddles {
+    int64_t k, m;
+    std::vector<T> p;                    // [k]
+    std::vector<T> values;               // [k, m], the table the companions were derived from
+    std::vector<ShoupWord<T>> w;         // [k, m]
+    std::vector<ShoupWord<T>> w_shoup;   // [k, m]
+
+    // Set when every modulus takes the Shoup kernels. The vector kernels then read the
+    // same table twiddle-major, with the k residues of one twiddle index side by side and
+    // repeated cyclically to lane_stride = k + max_simd_lanes - 1 columns, so a block of
+    // lanes starting at residue t reads one contiguous run lane_w[idx * lane_stride + t ...].
+    bool all_lazy = false;
+    int64_t lane_stride = 0;
+    std::vector<ShoupWord<T>> lane_p;        // [lane_stride]
+    std::vector<ShoupWord<T>> lane_w;        // [m, lane_stride]
+    std::vector<ShoupWord<T>> lane_w_shoup;  // [m, lane_stride]
+};
+
+// Reads p[k] and a [k, m] twiddle tensor into plain vectors.
+template <typename T>
+std::vector<T> read_moduli(const std::shared_ptr<DeviceTensor<T>>& p, int64_t k) {
+    std::vector<T> values(k);
+    for (int64_t t = 0; t < k; ++t) values[t] = p->at({t});
+    return values;
+}
+
+template <typename T>
+std::vector<T> read_twiddles(const std::shared_ptr<DeviceTensor<T>>& twiddles, int64_t k, int64_t m) {
+    std::vector<T> values(k * m);
+    if (twiddles->is_contiguous()) {
+        const T* src = reinterpret_cast<const T*>(twiddles->data.get());
+        std::copy(src, src + k * m, values.begin());
+    } else {
+        for (int64_t t = 0; t < k; ++t)
+            for (int64_t u = 0; u < m; ++u)
+                values[t * m + u] = twiddles->at({t, u});
+    }
+    return values;
+}
+
+// Derives the Shoup companions (one wide division each) and the lane tables of a
+// twiddle table.
+template <typename T>
+std::shared_ptr<const ShoupTwiddles<T>> build_shoup_twiddles(
+    std::vector<T> p_values, std::vector<T> values, int64_t k, int64_t m
+) {
+    auto entry = std::make_shared<ShoupTwiddles<T>>();
+    entry->k = k;
+    entry->m = m;
+    entry->w.resize(k * m);
+    entry->w_shoup.resize(k * m);
+    for (int64_t t = 0; t < k; ++t) {
+        if (!use_lazy_shoup<T>(p_values[t])) continue;  // served by the division kernels
+        const ShoupWord<T> mod = static_cast<ShoupWord<T>>(p_values[t]);
+        for (int64_t u = 0; u < m; ++u) {
+            const ShoupWord<T> w = static_cast<ShoupWord<T>>(values[t * m + u]) % mod;
+            entry->w[t * m + u] = w;
+            entry->w_shoup[t * m + u] = shoup_precompute<T>(w, mod);
+        }
+    }
+
+    entry->all_lazy = std::all_of(p_values.begin(), p_values.end(), use_lazy_shoup<T>);
+    if (entry->all_lazy) {
+        const int64_t stride = k + max_simd_lanes - 1;
+        entry->lane_stride = stride;
+        entry->lane_p.resize(stride);
+        entry->lane_w.resize(m * stride);
+        entry->lane_w_shoup.resize(m * stride);
+        for (int64_t q = 0; q < stride; ++q) {
+            const int64_t t = q % k;
+            entry->lane_p[q] = static_cast<ShoupWord<T>>(p_values[t]);
+            for (int64_t u = 0; u < m; ++u) {
+                entry->lane_w[u * stride + q] = entry->w[t * m + u];
+                entry->lane_w_shoup[u * stride + q] = entry->w_shoup[t * m + u];
+            }
+        }
+    }
+    entry->p = std::move(p_values);
+    entry->values = std::move(values);
+    return entry;
+}
+
+// Transcripts call the transforms with the same moduli and twiddles over and over, so
+// the tensor entry points keep recent tables in a small cache (an NttPlan holds its own).
+// Entries are matched on content, so a reused or rewritten buffer can never hit stale data.
+template <typename T>
+std::shared_ptr<const ShoupTwiddles<T>> get_shoup_twiddles(
+    const std::shared_ptr<DeviceTensor<T>>& p,
+    const std::shared_ptr<DeviceTensor<T>>& twiddles,
+    int64_t k, int64_t m
+) {
+    constexpr size_t max_entries = 16;
+    static std::mutex cache_mutex;
+    static std::deque<std::shared_ptr<const ShoupTwiddles<T>>> cache;
+
+    std::vector<T> p_values = read_moduli<T>(p, k);
+    std::vector<T> values = read_twiddles<T>(twiddles, k, m);
+
+    {
+        std::lock_guard<std::mutex> lock(cache_mutex);
+        for (const auto& entry : cache) {
+            if (entry->k == k && entry->m == m && entry->p == p_values && entry->values == values)
+                return entry;
+        }
+    }
+
+    auto entry = build_shoup_twiddles<T>(std::move(p_values), std::move(values), k, m);
+
+    std::lock_guard<std::mutex> lock(cache_mutex);
+    if (cache.size() == max_entries) cache.pop_front();
+    cache.push_back(entry);
+    return entry;
+}
+
+// The last inverse stage has a single group with twiddle w[1]; its outputs are scaled by
+// m^-1 and w[1] * m^-1 instead (with Shoup companions on the lazy path), computed in
+// double width: w[t * 4 ...] = {m^-1, m^-1', w[1] m^-1, (w[1] m^-1)'}. For the vector
+// kernels the same four rows are laid out like the lane twiddle tables, [4, lane_stride].
+template <typename T>
+struct InverseFold {
+    std::vector<ShoupWord<T>> w;       // [k, 4]
+    std::vector<ShoupWord<T>> lane_w;  // [4, lane_stride], only with table.all_lazy
+};
+
+template <typename T>
+InverseFold<T> make_inverse_fold(const ShoupTwiddles<T>& table,
+                                 const std::shared_ptr<DeviceTensor<T>>& m_inv) {
+    using W = ShoupWord<T>;
+    const int64_t k = table.k, m = table.m;
+
+    InverseFold<T> fold;
+    fold.w.resize(4 * k);
+    for (int64_t t = 0; t < k; ++t) {
+        const T mod = table.p[t];
+        const DivisionReducer<T> red{mod};
+        const T m_inv_t = red.mul(m_inv->at({t}), T(1));
+        const T w1_m_inv = m > 1 ? red.mul(table.values[t * m + 1], m_inv_t) : m_inv_t;
+        fold.w[4 * t] = static_cast<W>(m_inv_t);
+        fold.w[4 * t + 2] = static_cast<W>(w1_m_inv);
+        if (use_lazy_shoup<T>(mod)) {
+            fold.w[4 * t + 1] = shoup_precompute<T>(static_cast<W>(m_inv_t), static_cast<W>(mod));
+            fold.w[4 * t + 3] = shoup_precompute<T>(static_cast<W>(w1_m_inv), static_cast<W>(mod));
+        }
+    }
+
+    if (table.all_lazy) {
+        fold.lane_w.resize(4 * table.lane_stride);
+        for (int64_t e = 0; e < 4; ++e)
+            for (int64_t q = 0; q < table.lane_stride; ++q)
+                fold.lane_w[e * table.lane_stride + q] = fold.w[4 * (q % k) + e];
+    }
+    return fold;
+}
+
+// Base pointer and per-axis element strides of an [l, m, r, k] tensor, so a kernel can
+// walk any (i, j, t) line as base + offset + u * m_stride without going through at().
+template <typename T>
+struct LineLayout {
+    T* base;
+    int64_t l_stride, m_stride, r_stride, k_stride;
+
+    explicit LineLayout(const DeviceTensor<T>& tensor)
+        : base(reinterpret_cast<T*>(tensor.data.get())),
+          l_stride(tensor.strides[0]), m_stride(tensor.strides[1]),
+          r_stride(tensor.strides[2]), k_stride(tensor.strides[3]) {}
+
+    T* line(int64_t i, int64_t j, int64_t t) const {
+        return base + i * l_stride + j * r_stride + t * k_stride;
+    }
+};
+
+// Read perm into a plain index vector, rejecting entries outside [0, m).
+template <typename T>
+std::vector<int64_t> load_permutation(const std::shared_ptr<DeviceTensor<T>>& perm, int64_t m) {
+    if (!perm)
+        throw std::invalid_argument("Tensor 'perm' is required unless skip_perm is set.");
+    std::vector<int64_t> indices(m);
+    for (int64_t u = 0; u < m; ++u) {
+        indices[u] = perm->at({u});
+        if (indices[u] < 0 || indices[u] >= m)
+            throw std::out_of_range("Permutation index out of bounds.");
+    }
+    return indices;
+}
+
+// Forward Cooley-Tukey stages over an n-point strided block. Group u of the stage with
+// `stage` groups uses twiddle w[stage * root + u]: root = 1 is the whole transform, and
+// the blocked schedule below runs row i of the line with root = n1 + i.
+template <typename T, typename Reducer>
+void ntt_stages(T* x, int64_t stride, int64_t n, int64_t root, const T* w, const Reducer& red) {
+    int64_t step = n;
+    for (int64_t stage = 1; stage < n; stage *= 2) {
+        step /= 2;
+        for (int64_t u = 0; u < stage; ++u) {
+            T* x1 = x + 2 * u * step * stride;
+            T* x2 = x1 + step * stride;
+            const T s = w[stage * root + u];
+
+            for (int64_t jx = 0; jx < step * stride; jx += stride) {
+                T u_val = x1[jx];
+                T v_mod = red.mul(x2[jx], s);
+                x1[jx] = red.add(u_val, v_mod);
+                x2[jx] = red.sub(u_val, v_mod);
+            }
+        }
+    }
+}
+
+// Inverse Gentleman-Sande stages over an n-point strided block; group g of the stage with
+// `half` groups uses twiddle w[half * root + g]. With `fold` = {m^-1, w[root] * m^-1} the
+// last stage (half = 1) also applies the m^-1 scaling, so no separate pass is needed.
+template <typename T, typename Reducer>
+void intt_stages(T* x, int64_t stride, int64_t n, int64_t root, const T* w, const T* fold,
+                 const Reducer& red) {
+    int64_t t_stride = 1;
+    for (int64_t half = n / 2; half >= 1; half /= 2) {
+        const bool scaled = fold && half == 1;
+        for (int64_t group = 0; group < half; ++group) {
+            T* x1 = x + group * t_stride * 2 * stride;
+            T* x2 = x1 + t_stride * stride;
+            const T s = scaled ? fold[1] : w[half * root + group];
+            const T s_sum = scaled ? fold[0] : T(0);
+
+            for (int64_t jx = 0; jx < t_stride * stride; jx += stride) {
+                T u_val = x1[jx];
+                T v_val = x2[jx];
+                x1[jx] = scaled ? red.mul(red.add(u_val, v_val), s_sum) : red.add(u_val, v_val);
+                x2[jx] = red.mul(red.sub(u_val, v_val), s);
+            }
+        }
+        t_stride *= 2;
+    }
+}
+
+// Harvey forward butterfly: (a, b) in [0, 4p) -> (a + wb, a - wb) in [0, 4p).
+template <typename T>
+inline void ct_butterfly_shoup(ShoupWord<T>& a, ShoupWord<T>& b, ShoupWord<T> s,
+                               ShoupWord<T> s_shoup, ShoupWord<T> mod, ShoupWord<T> two_p) {
+    ShoupWord<T> u_val = a - (a >= two_p ? two_p : 0);
+    ShoupWord<T> v_val = shoup_mul_lazy<T>(b, s, s_shoup, mod);
+    a = u_val + v_val;
+    b = u_val + two_p - v_val;
+}
+
+// Gentleman-Sande butterfly: (a, b) in [0, 2p) -> (a + b, (a - b) w) in [0, 2p).
+template <typename T>
+inline void gs_butterfly_shoup(ShoupWord<T>& a, ShoupWord<T>& b, ShoupWord<T> s,
+                               ShoupWord<T> s_shoup, ShoupWord<T> mod, ShoupWord<T> two_p) {
+    ShoupWord<T> diff = a + two_p - b;
+    ShoupWord<T> sum = a + b;
+    a = sum - (sum >= two_p ? two_p : 0);
+    b = shoup_mul_lazy<T>(diff, s, s_shoup, mod);
+}
+
+// Last Gentleman-Sande butterfly with the m^-1 scaling folded into its twiddles:
+// (a, b) in [0, 2p) -> ((a + b) m^-1, (a - b) w m^-1) in [0, p). fold holds
+// {m^-1, w * m^-1} with their Shoup companions as {m^-1, m^-1', w m^-1, (w m^-1)'}.
+template <typename T>
+inline void gs_butterfly_shoup_scaled(ShoupWord<T>& a, ShoupWord<T>& b, const ShoupWord<T>* fold,
+                                      ShoupWord<T> mod, ShoupWord<T> two_p) {
+    ShoupWord<T> diff = a + two_p - b;
+    ShoupWord<T> sum = shoup_mul_lazy<T>(a + b, fold[0], fold[1], mod);
+    diff = shoup_mul_lazy<T>(diff, fold[2], fold[3], mod);
+    a = sum - (sum >= mod ? mod : 0);
+    b = diff - (diff >= mod ? mod : 0);
+}
+
+// Forward stages with Shoup twiddle multiplies. Values are kept lazily in [0, 4p)
+// (Harvey's butterfly); requires p < lazy_modulus_bound<T>().
+//
+// Stages `stage` and `2 * stage` are merged into one radix-4 sweep: group u's four
+// quarters go through the stage-`stage` butterflies (twiddle u) and then the two
+// stage-`2 * stage` butterflies (twiddles 2u, 2u + 1) while still in registers. An odd
+// log2(n) leaves one radix-2 stage at the end. Every element sees the same butterflies
+// as in the stage-by-stage order, so the output is bit-identical.
+template <typename T>
+void ntt_stages_shoup(
+    ShoupWord<T>* x, int64_t stride, int64_t n, int64_t root,
+    const ShoupWord<T>* w, const ShoupWord<T>* w_shoup, ShoupWord<T> mod
 ) {
-    for (int64_t i = 0; i < l; ++i) {
-        for (int64_t j = 0; j < r; ++j) {
-            for (int64_t t = 0; t < k; ++t) {
-                std::vector<T> temp(m);
-                for (int64_t u = 0; u < m; ++u) {
-                    int64_t pu = perm->at({u});
-                    temp[u] = result->at({i, pu, j, t});
-                }
-                for (int64_t u = 0; u < m; ++u) {
-                    result->at({i, u, j, t}) = temp[u];
-                }
+    using W = ShoupWord<T>;
+    const W two_p = 2 * mod;
+
+    int64_t stage = 1;
+    for (; 4 * stage <= n; stage *= 4) {
+        const int64_t quarter = n / (4 * stage);
+        for (int64_t u = 0; u < stage; ++u) {
+            W* x0 = x + 4 * u * quarter * stride;
+            W* x1 = x0 + quarter * stride;
+            W* x2 = x1 + quarter * stride;
+            W* x3 = x2 + quarter * stride;
+            const int64_t i1 = stage * root + u;
+            const int64_t i2 = 2 * stage * root + 2 * u;
+            const W s1 = w[i1], s1_shoup = w_shoup[i1];
+            const W s2 = w[i2], s2_shoup = w_shoup[i2];
+            const W s3 = w[i2 + 1], s3_shoup = w_shoup[i2 + 1];
+
+            for (int64_t jx = 0; jx < quarter * stride; jx += stride) {
+                W a0 = x0[jx], a1 = x1[jx], a2 = x2[jx], a3 = x3[jx];
+                ct_butterfly_shoup<T>(a0, a2, s1, s1_shoup, mod, two_p);
+                ct_butterfly_shoup<T>(a1, a3, s1, s1_shoup, mod, two_p);
+                ct_butterfly_shoup<T>(a0, a1, s2, s2_shoup, mod, two_p);
+                ct_butterfly_shoup<T>(a2, a3, s3, s3_shoup, mod, two_p);
+                x0[jx] = a0; x1[jx] = a1; x2[jx] = a2; x3[jx] = a3;
+            }
+        }
+    }
+
+    if (stage < n) {
+        const int64_t step = n / (2 * stage);
+        for (int64_t u = 0; u < stage; ++u) {
+            W* x1 = x + 2 * u * step * stride;
+            W* x2 = x1 + step * stride;
+            const W s = w[stage * root + u];
+            const W s_shoup = w_shoup[stage * root + u];
+
+            for (int64_t jx = 0; jx < step * stride; jx += stride)
+                ct_butterfly_shoup<T>(x1[jx], x2[jx], s, s_shoup, mod, two_p);
+        }
+    }
+}
+
+// One radix-4 Gentleman-Sande sweep of intt_stages_shoup: stages `half` and `half / 2`.
+// With Scaled the second one is the transform's last stage and takes the fold table.
+template <typename T, bool Scaled>
+void intt_sweep_shoup(
+    ShoupWord<T>* x, int64_t stride, int64_t half, int64_t t_stride, int64_t root,
+    const ShoupWord<T>* w, const ShoupWord<T>* w_shoup, ShoupWord<T> mod,
+    const ShoupWord<T>* fold
+) {
+    using W = ShoupWord<T>;
+    const W two_p = 2 * mod;
+
+    for (int64_t group = 0; group < half / 2; ++group) {
+        W* x0 = x + group * t_stride * 4 * stride;
+        W* x1 = x0 + t_stride * stride;
+        W* x2 = x1 + t_stride * stride;
+        W* x3 = x2 + t_stride * stride;
+        const int64_t i1 = half * root + 2 * group;
+        const int64_t i3 = (half / 2) * root + group;
+        const W s1 = w[i1], s1_shoup = w_shoup[i1];
+        const W s2 = w[i1 + 1], s2_shoup = w_shoup[i1 + 1];
+        const W s3 = w[i3], s3_shoup = w_shoup[i3];
+
+        for (int64_t jx = 0; jx < t_stride * stride; jx += stride) {
+            W a0 = x0[jx], a1 = x1[jx], a2 = x2[jx], a3 = x3[jx];
+            gs_butterfly_shoup<T>(a0, a1, s1, s1_shoup, mod, two_p);
+            gs_butterfly_shoup<T>(a2, a3, s2, s2_shoup, mod, two_p);
+            if (Scaled) {
+                gs_butterfly_shoup_scaled<T>(a0, a2, fold, mod, two_p);
+                gs_butterfly_shoup_scaled<T>(a1, a3, fold, mod, two_p);
+            } else {
+                gs_butterfly_shoup<T>(a0, a2, s3, s3_shoup, mod, two_p);
+                gs_butterfly_shoup<T>(a1, a3, s3, s3_shoup, mod, two_p);
             }
+            x0[jx] = a0; x1[jx] = a1; x2[jx] = a2; x3[jx] = a3;
         }
     }
 }
 
+// Inverse stages with Shoup twiddle multiplies. Values stay in [0, 2p); requires
+// p < lazy_modulus_bound<T>(). Stages `half` and `half / 2` are merged into radix-4
+// sweeps like ntt_stages_shoup, with a radix-2 stage (half = 1) left for odd log2(n).
+// With a `fold` table (see gs_butterfly_shoup_scaled) the last stage also scales by m^-1
+// and leaves the block fully reduced.
+template <typename T>
+void intt_stages_shoup(
+    ShoupWord<T>* x, int64_t stride, int64_t n, int64_t root,
+    const ShoupWord<T>* w, const ShoupWord<T>* w_shoup, ShoupWord<T> mod,
+    const ShoupWord<T>* fold
+) {
+    using W = ShoupWord<T>;
+    const W two_p = 2 * mod;
+
+    int64_t t_stride = 1;
+    int64_t half = n / 2;
+    for (; half >= 2; half /= 4, t_stride *= 4) {
+        if (fold && half == 2)
+            intt_sweep_shoup<T, true>(x, stride, half, t_stride, root, w, w_shoup, mod, fold);
+        else
+            intt_sweep_shoup<T, false>(x, stride, half, t_stride, root, w, w_shoup, mod, fold);
+    }
+
+    if (half == 1) {
+        W* x1 = x;
+        W* x2 = x1 + t_stride * stride;
+        if (fold) {
+            for (int64_t jx = 0; jx < t_stride * stride; jx += stride)
+                gs_butterfly_shoup_scaled<T>(x1[jx], x2[jx], fold, mod, two_p);
+        } else {
+            for (int64_t jx = 0; jx < t_stride * stride; jx += stride)
+                gs_butterfly_shoup<T>(x1[jx], x2[jx], w[root], w_shoup[root], mod, two_p);
+        }
+    }
+}
+
+// Split of a blocked m-point line into n1 rows of n2 = m / n1 elements, n1 <= n2.
+struct FourStepSplit {
+    int64_t n1, n2;
+
+    explicit FourStepSplit(int64_t m) {
+        int64_t log_m = 0;
+        while ((int64_t(1) << log_m) < m) ++log_m;
+        n1 = int64_t(1) << (log_m / 2);
+        n2 = m / n1;
+    }
+};
+
+bool use_four_step(int64_t m) {
+    const int64_t threshold = four_step_threshold.load(std::memory_order_relaxed);
+    return threshold > 0 && m >= 4 && m >= threshold;
+}
+
+// Sub-transforms gathered together per pass of run_blocked.
+constexpr int64_t four_step_group = 8;
+
+// Runs `stages` on `count` n-point sub-transforms of the blocked schedule: sub-transform b
+// starts at element b * step and has its points n_stride elements apart. An
+// element is `lanes` adjacent words (1 for a scalar line, one vector for the column
+// kernels). Sub-transforms at power-of-two strides keep evicting each other from the
+// cache sets and TLB, so unless they are contiguous already they are gathered, a group
+// of neighbours at a time, into contiguous scratch blocks, transformed there and
+// scattered back.
+template <typename Word, typename Stages>
+void run_blocked(Word* x, int64_t stride, int64_t lanes, int64_t count, int64_t step,
+                 int64_t n, int64_t n_stride, int64_t root0, int64_t root_step,
+                 std::vector<Word>& scratch, const Stages& stages) {
+    if (n_stride * stride == lanes) {
+        for (int64_t b = 0; b < count; ++b)
+            stages(x + b * step * stride, lanes, n, root0 + b * root_step);
+        return;
+    }
+
+    for (int64_t b0 = 0; b0 < count; b0 += four_step_group) {
+        const int64_t group = std::min(four_step_group, count - b0);
+        for (int64_t e = 0; e < n; ++e) {
+            for (int64_t g = 0; g < group; ++g) {
+                const Word* src = x + ((b0 + g) * step + e * n_stride) * stride;
+                std::copy(src, src + lanes, &scratch[(g * n + e) * lanes]);
+            }
+        }
+        for (int64_t g = 0; g < group; ++g)
+            stages(&scratch[g * n * lanes], lanes, n, root0 + (b0 + g) * root_step);
+        for (int64_t e = 0; e < n; ++e) {
+            for (int64_t g = 0; g < group; ++g) {
+                Word* dst = x + ((b0 + g) * step + e * n_stride) * stride;
+                std::copy(&scratch[(g * n + e) * lanes], &scratch[(g * n + e) * lanes] + lanes, dst);
+            }
+        }
+    }
+}
+
+// Cache-blocked (four-step) order of the forward stages. Viewed as a row-major n1 x n2
+// matrix, the first log2(n1) stages only pair elements of one column and the remaining
+// ones only elements of one row, so every column is transformed first and then every
+// row, each while it sits in cache. The inter-step twiddles of the textbook algorithm
+// are already part of the bit-reversed table (row i runs with root n1 + i) and the
+// output lands in bit-reversed order in place, so no transposes are needed and the
+// result matches the plain radix-2 order bit for bit.
+// `stages(block, stride, n, root)` runs the forward stages of one n-point block.
+template <typename Word, typename Stages>
+void ntt_schedule(Word* x, int64_t stride, int64_t lanes, int64_t m, const Stages& stages) {
+    if (!use_four_step(m)) {
+        stages(x, stride, m, 1);
+        return;
+    }
+    const FourStepSplit split(m);
+    std::vector<Word> scratch(four_step_group * split.n2 * lanes);
+    // columns: n1 points at distance n2, root 1
+    run_blocked(x, stride, lanes, split.n2, 1, split.n1, split.n2, 1, 0, scratch, stages);
+    // rows: n2 adjacent points, root n1 + row
+    run_blocked(x, stride, lanes, split.n1, split.n2, split.n2, 1, split.n1, 1, scratch, stages);
+}
+
+// Inverse counterpart of ntt_schedule: Gentleman-Sande starts with the short butterflies,
+// so the rows come first and the columns last. Either way the blocks run with root 1
+// are the ones that end in the transform's last stage.
+template <typename Word, typename Stages>
+void intt_schedule(Word* x, int64_t stride, int64_t lanes, int64_t m, const Stages& stages) {
+    if (!use_four_step(m)) {
+        stages(x, stride, m, 1);
+        return;
+    }
+    const FourStepSplit split(m);
+    std::vector<Word> scratch(four_step_group * split.n2 * lanes);
+    run_blocked(x, stride, lanes, split.n1, split.n2, split.n2, 1, split.n1, 1, scratch, stages);
+    run_blocked(x, stride, lanes, split.n2, 1, split.n1, split.n2, 1, 0, scratch, stages);
+}
+
+// Forward transform of a strided line with bit-reversed twiddles w[m]. Output is left in
+// bit-reversed order.
+template <typename T, typename Reducer>
+void ntt_butterflies(T* x, int64_t stride, int64_t m, const T* w, const Reducer& red) {
+    ntt_schedule(x, stride, 1, m, [&](T* block, int64_t s, int64_t n, int64_t root) {
+        ntt_stages<T>(block, s, n, root, w, red);
+    });
+}
+
+// Inverse transform of a strided line with bit-reversed inverse twiddles w[m]; the m^-1
+// scaling rides on the last stage through fold = {m^-1, w[1] * m^-1}.
+template <typename T, typename Reducer>
+void intt_butterflies(T* x, int64_t stride, int64_t m, const T* w, const T* fold, const Reducer& red) {
+    intt_schedule(x, stride, 1, m, [&](T* block, int64_t s, int64_t n, int64_t root) {
+        intt_stages<T>(block, s, n, root, w, root == 1 ? fold : nullptr, red);
+    });
+}
+
+// Forward transform with Shoup twiddle multiplies, fully reduced at the end.
+// Requires inputs in [0, 4p) and p < lazy_modulus_bound<T>().
+template <typename T>
+void ntt_butterflies_shoup(
+    ShoupWord<T>* x, int64_t stride, int64_t m,
+    const ShoupWord<T>* w, const ShoupWord<T>* w_shoup, ShoupWord<T> mod
+) {
+    using W = ShoupWord<T>;
+    const W two_p = 2 * mod;
+
+    ntt_schedule(x, stride, 1, m, [&](W* block, int64_t s, int64_t n, int64_t root) {
+        ntt_stages_shoup<T>(block, s, n, root, w, w_shoup, mod);
+    });
+
+    for (int64_t u = 0; u < m * stride; u += stride) {
+        W val = x[u];
+        if (val >= two_p) val -= two_p;
+        if (val >= mod) val -= mod;
+        x[u] = val;
+    }
+}
+
+// Inverse transform with Shoup twiddle multiplies, with the m^-1 scaling folded into the
+// last stage (see gs_butterfly_shoup_scaled), so the output is fully reduced without an
+// extra pass. Requires inputs in [0, 2p) and p < lazy_modulus_bound<T>().
+template <typename T>
+void intt_butterflies_shoup(
+    ShoupWord<T>* x, int64_t stride, int64_t m,
+    const ShoupWord<T>* w, const ShoupWord<T>* w_shoup, ShoupWord<T> mod,
+    const ShoupWord<T>* fold
+) {
+    using W = ShoupWord<T>;
+
+    intt_schedule(x, stride, 1, m, [&](W* block, int64_t s, int64_t n, int64_t root) {
+        intt_stages_shoup<T>(block, s, n, root, w, w_shoup, mod, root == 1 ? fold : nullptr);
+    });
+}
+
+// The vector kernels need every modulus on the Shoup path.
+template <typename T>
+bool use_simd_columns(SimdLevel level, const ShoupTwiddles<T>& table) {
+    return level != SimdLevel::scalar && table.all_lazy;
+}
+
+// Schedule shared by every path. Slab i of an [l, m, r, k] tensor has r * k columns, the
+// (j, t) lines, and is cut into blocks of `width` adjacent columns that are transformed
+// across all m rows at once; columns left over when r * k is not a multiple of the width
+// go one by one. `block(i, c0, lanes, scratch)` handles columns [c0, c0 + lanes) with a
+// per-thread scratch of m * width words. With width 1 this is one task per (i, j, t)
+// line; the static schedule hands each thread a contiguous run of tasks, so neighbouring
+// residues in a cache line mostly stay on one thread.
+template <typename Word, typename Block>
+void for_each_column_block(int64_t l, int64_t m, int64_t r, int64_t k, int64_t width,
+                           const Block& block) {
+    const int64_t columns = r * k;
+    const int64_t blocks = columns / width;
+    const int64_t tasks_per_slab = blocks + columns % width;
+
+    #pragma omp parallel
+    {
+        std::vector<Word> scratch(m * width);
+
+        #pragma omp for schedule(static)
+        for (int64_t task = 0; task < l * tasks_per_slab; ++task) {
+            const int64_t i = task / tasks_per_slab;
+            const int64_t q = task % tasks_per_slab;
+            if (q < blocks) {
+                block(i, q * width, width, scratch.data());
+            } else {
+                block(i, blocks * width + (q - blocks), 1, scratch.data());
+            }
+        }
+    }
+}
+
+// Element offsets of columns [c0, c0 + lanes) of slab i, and the residue index t of each.
+template <typename T>
+void column_offsets(const LineLayout<T>& layout, int64_t i, int64_t c0, int64_t lanes, int64_t k,
+                    int64_t* offset, int64_t* residue) {
+    for (int64_t c = 0; c < lanes; ++c) {
+        residue[c] = (c0 + c) % k;
+        offset[c] = layout.line(i, (c0 + c) / k, residue[c]) - layout.base;
+    }
+}
+
+// Gather columns [c0, c0 + lanes) of slab i into the row-major [m, lanes] scratch,
+// reducing into [0, p). Input row u lands on scratch row dst_row[u], or on row u when
+// dst_row is null; this is where intt() applies its input permutation.
+template <typename T>
+void load_columns(const LineLayout<T>& in, int64_t i, int64_t c0, int64_t lanes, int64_t k, int64_t m,
+                  const std::vector<T>& p, const int64_t* dst_row, T* scratch) {
+    int64_t offset[max_simd_lanes], residue[max_simd_lanes];
+    column_offsets(in, i, c0, lanes, k, offset, residue);
+    T mod[max_simd_lanes];
+    for (int64_t c = 0; c < lanes; ++c) mod[c] = p[residue[c]];
+
+    for (int64_t u = 0; u < m; ++u) {
+        const T* src = in.base + u * in.m_stride;
+        T* dst = scratch + (dst_row ? dst_row[u] : u) * lanes;
+        for (int64_t c = 0; c < lanes; ++c) {
+            T val = src[offset[c]];
+            dst[c] = val < mod[c] ? val : val % mod[c];
+        }
+    }
+}
+
+// Scatter the [m, lanes] scratch back to columns [c0, c0 + lanes) of slab i. Output row u
+// takes scratch row src_row[u], or row u when src_row is null; this is where ntt()
+// applies its output permutation, so it costs no extra pass over the tensor.
+template <typename T>
+void store_columns(const LineLayout<T>& out, int64_t i, int64_t c0, int64_t lanes, int64_t k, int64_t m,
+                   const int64_t* src_row, const T* scratch) {
+    int64_t offset[max_simd_lanes], residue[max_simd_lanes];
+    column_offsets(out, i, c0, lanes, k, offset, residue);
+
+    for (int64_t u = 0; u < m; ++u) {
+        const T* src = scratch + (src_row ? src_row[u] : u) * lanes;
+        T* dst = out.base + u * out.m_stride;
+        for (int64_t c = 0; c < lanes; ++c) {
+            dst[offset[c]] = src[c];
+        }
+    }
+}
+
+// Forward transform of every (i, j, t) line of `a` into `result`. Every block of columns
+// is gathered into a contiguous per-thread scratch, transformed there and scattered to
+// `result` through out_row (the permutation, or null for bit-reversed order): one read
+// of `a` and one write of `result` per transform, whatever their strides.
+template <typename T>
+void run_ntt(const DeviceTensor<T>& a, const ShoupTwiddles<T>& table, const int64_t* out_row,
+             DeviceTensor<T>& result) {
+    using W = ShoupWord<T>;
+    const int64_t l = a.dims[0], m = a.dims[1], r = a.dims[2], k = a.dims[3];
+
+    const LineLayout<T> in(a);
+    const LineLayout<T> out(result);
+
+    const SimdLevel level = simd_level();
+    const int64_t width = use_simd_columns<T>(level, table) ? simd_lanes<T>(level) : 1;
+
+    for_each_column_block<W>(l, m, r, k, width, [&](int64_t i, int64_t c0, int64_t lanes, W* scratch) {
+        T* x = reinterpret_cast<T*>(scratch);
+        load_columns<T>(in, i, c0, lanes, k, m, table.p, nullptr, x);
+
+        if (lanes > 1) {
+            const int64_t lane = c0 % k;
+            ntt_schedule(scratch, lanes, lanes, m, [&](W* block, int64_t s, int64_t n, int64_t root) {
+                LATTICA_SIMD_CALL(level, ntt_column_stages, block, s, n, root, lanes,
+                                  &table.lane_w[lane], &table.lane_w_shoup[lane],
+                                  table.lane_stride, &table.lane_p[lane]);
+            });
+            LATTICA_SIMD_CALL(level, ntt_column_reduce, scratch, lanes, m, lanes, &table.lane_p[lane]);
+        } else {
+            const int64_t t = c0 % k;
+            const T mod = table.p[t];
+            if (use_lazy_shoup<T>(mod)) {
+                ntt_butterflies_shoup<T>(scratch, 1, m, &table.w[t * m], &table.w_shoup[t * m],
+                                         static_cast<W>(mod));
+            } else {
+                ntt_butterflies<T>(x, 1, m, &table.values[t * m], DivisionReducer<T>{mod});
+            }
+        }
+
+        store_columns<T>(out, i, c0, lanes, k, m, out_row, x);
+    });
+}
+
+// Inverse counterpart of run_ntt; in_row (or null) is applied while gathering.
+template <typename T>
+void run_intt(const DeviceTensor<T>& a, const ShoupTwiddles<T>& table, const InverseFold<T>& fold,
+              const int64_t* in_row, DeviceTensor<T>& result) {
+    using W = ShoupWord<T>;
+    const int64_t l = a.dims[0], m = a.dims[1], r = a.dims[2], k = a.dims[3];
+
+    const LineLayout<T> in(a);
+    const LineLayout<T> out(result);
+
+    const SimdLevel level = simd_level();
+    const int64_t width = use_simd_columns<T>(level, table) ? simd_lanes<T>(level) : 1;
+
+    for_each_column_block<W>(l, m, r, k, width, [&](int64_t i, int64_t c0, int64_t lanes, W* scratch) {
+        T* x = reinterpret_cast<T*>(scratch);
+        load_columns<T>(in, i, c0, lanes, k, m, table.p, in_row, x);
+
+        if (lanes > 1) {
+            const int64_t lane = c0 % k;
+            intt_schedule(scratch, lanes, lanes, m, [&](W* block, int64_t s, int64_t n, int64_t root) {
+                LATTICA_SIMD_CALL(level, intt_column_stages, block, s, n, root, lanes,
+                                  &table.lane_w[lane], &table.lane_w_shoup[lane],
+                                  table.lane_stride, &table.lane_p[lane],
+                                  root == 1 ? &fold.lane_w[lane] : nullptr);
+            });
+        } else {
+            const int64_t t = c0 % k;
+            const T mod = table.p[t];
+            if (use_lazy_shoup<T>(mod)) {
+                intt_butterflies_shoup<T>(scratch, 1, m, &table.w[t * m], &table.w_shoup[t * m],
+                                          static_cast<W>(mod), &fold.w[4 * t]);
+            } else {
+                const T division_fold[2] = {static_cast<T>(fold.w[4 * t]), static_cast<T>(fold.w[4 * t + 2])};
+                intt_butterflies<T>(x, 1, m, &table.values[t * m], division_fold,
+                                    DivisionReducer<T>{mod});
+            }
+        }
+
+        store_columns<T>(out, i, c0, lanes, k, m, nullptr, x);
+    });
+}
+
+// Checks a and result against a plan's m and k.
+template <typename T>
+void validate_plan_inputs(const std::shared_ptr<DeviceTensor<T>>& a,
+                          const std::shared_ptr<DeviceTensor<T>>& result,
+                          int64_t m, int64_t k) {
+    if (a->dims.size() != 4 || a->dims[1] != m || a->dims[3] != k)
+        throw std::invalid_argument("Input tensor 'a' must have shape [l, m, r, k] matching the plan.");
+    if (result->dims != a->dims)
+        throw std::invalid_argument("Output tensor must have the same shape as input tensor.");
+}
+
 } // namespace
 
+template <typename T>
+struct NttPlan<T>::Tables {
+    int64_t m = 0, k = 0;
+    std::vector<int64_t> perm;                        // empty when built without perm
+    std::shared_ptr<const ShoupTwiddles<T>> forward;  // null when built without twiddles
+    std::shared_ptr<const ShoupTwiddles<T>> inverse;  // null when built without inv_twiddles
+    InverseFold<T> fold;
+};
+
+template <typename T>
+NttPlan<T>::NttPlan(
+    const std::shared_ptr<DeviceTensor<T>>& p,
+    const std::shared_ptr<DeviceTensor<T>>& perm,
+    const std::shared_ptr<DeviceTensor<T>>& twiddles,
+    const std::shared_ptr<DeviceTensor<T>>& inv_twiddles,
+    const std::shared_ptr<DeviceTensor<T>>& m_inv,
+    const std::shared_ptr<DeviceTensor<T>>& /*log2p_list*/,
+    const std::shared_ptr<DeviceTensor<T>>& /*mu_list*/
+) {
+    if (!p || p->dims.size() != 1)
+        throw std::invalid_argument("Tensor 'p' must have shape [k].");
+    if (!twiddles && !inv_twiddles)
+        throw std::invalid_argument("NttPlan needs 'twiddles', 'inv_twiddles' or both.");
+    if (inv_twiddles && !m_inv)
+        throw std::invalid_argument("Tensor 'm_inv' is required with 'inv_twiddles'.");
+
+    auto tables = std::make_shared<Tables>();
+    const int64_t k = p->dims[0];
+    const auto& shape = (twiddles ? twiddles : inv_twiddles)->dims;
+    const int64_t m = shape.size() == 2 ? shape[1] : 0;
+    tables->k = k;
+    tables->m = m;
+
+    for (const auto* table : {&twiddles, &inv_twiddles}) {
+        if (*table && ((*table)->dims.size() != 2 || (*table)->dims[0] != k || (*table)->dims[1] != m))
+            throw std::invalid_argument("Tensors 'twiddles' and 'inv_twiddles' must have shape [k, m].");
+    }
+    if (m_inv && (m_inv->dims.size() != 1 || m_inv->dims[0] != k))
+        throw std::invalid_argument("Tensor 'm_inv' must have shape [k].");
+    if (perm && (perm->dims.size() != 1 || perm->dims[0] != m))
+        throw std::invalid_argument("Tensor 'perm' must have shape [m].");
+    const std::vector<T> p_values = read_moduli<T>(p, k);
+    if (perm) tables->perm = load_permutation<T>(perm, m);
+    if (twiddles)
+        tables->forward = build_shoup_twiddles<T>(p_values, read_twiddles<T>(twiddles, k, m), k, m);
+    if (inv_twiddles) {
+        tables->inverse = build_shoup_twiddles<T>(p_values, read_twiddles<T>(inv_twiddles, k, m), k, m);
+        tables->fold = make_inverse_fold<T>(*tables->inverse, m_inv);
+    }
+    tables_ = std::move(tables);
+}
+
+template <typename T>
+int64_t NttPlan<T>::m() const {
+    return tables_->m;
+}
+
+template <typename T>
+int64_t NttPlan<T>::k() const {
+    return tables_->k;
+}
+
+void set_ntt_four_step_threshold(int64_t m) {
+    if (m < 0)
+        throw std::invalid_argument("Four-step threshold must be non-negative.");
+    four_step_threshold.store(m);
+}
+
+int64_t get_ntt_four_step_threshold() {
+    return four_step_threshold.load();
+}
+
 template <typename T>
 void ntt(
     const std::shared_ptr<DeviceTensor<T>>& a,
     const std::shared_ptr<DeviceTensor<T>>& p,
     const std::shared_ptr<DeviceTensor<T>>& perm,
     const std::shared_ptr<DeviceTensor<T>>& twiddles, // now [k, m]
-    const std::shared_ptr<DeviceTensor<T>>& log2p_list,
-    const std::shared_ptr<DeviceTensor<T>>& mu_list,
-    std::shared_ptr<DeviceTensor<T>>& result
+    const std::shared_ptr<DeviceTensor<T>>& /*log2p_list*/,
+    const std::shared_ptr<DeviceTensor<T>>& /*mu_list*/,
+    std::shared_ptr<DeviceTensor<T>>& result,
+    bool skip_perm
 ) {
     int64_t l, m, r, k;
     validate_ntt_inputs<T>(a, p, perm, twiddles, result, l, m, r, k);
 
-    #pragma omp parallel for collapse(2)
-    for (int64_t i = 0; i < l; ++i) {
-        for (int64_t j = 0; j < r; ++j) {
-            for (int64_t t = 0; t < k; ++t) {
-                T mod = p->at({t});
-
-                for (int64_t u = 0; u < m; ++u) {
-                    result->at({i, u, j, t}) = a->at({i, u, j, t});
-                }
-
-                int64_t n = m;
-                int64_t step = n;
-                for (int64_t stage = 1; stage < n; stage *= 2) {
-                    step /= 2;
-                    for (int64_t u = 0; u < stage; ++u) {
-                        int64_t j1 = 2 * u * step;
-                        int64_t j2 = j1 + step;
-                        T s = twiddles->at({t, stage + u});
-
-                        for (int64_t jx = j1; jx < j2; ++jx) {
-                            T u_val = result->at({i, jx, j, t});
-                            T v_val = result->at({i, jx + step, j, t});
-                            T_DP<T> v_tw = static_cast<T_DP<T>>(v_val) * static_cast<T_DP<T>>(s);
-                            T v_mod = static_cast<T>(v_tw % static_cast<T_DP<T>>(mod));
-                            result->at({i, jx, j, t}) = (u_val + v_mod) % mod;
-                            result->at({i, jx + step, j, t}) = (u_val + mod - v_mod) % mod;
-                        }
-                    }
-                }
-            }
-        }
-    }
+    auto table = get_shoup_twiddles<T>(p, twiddles, k, m);
+    const std::vector<int64_t> perm_idx = skip_perm ? std::vector<int64_t>() : load_permutation<T>(perm, m);
 
-    apply_permutation<T>(perm, result, l, r, k, m);
+    run_ntt<T>(*a, *table, skip_perm ? nullptr : perm_idx.data(), *result);
+    result->montgomery = a->montgomery;
 }
 
 template <typename T>
@@ -122,51 +888,56 @@ void intt(
     const std::shared_ptr<DeviceTensor<T>>& perm,
     const std::shared_ptr<DeviceTensor<T>>& inv_twiddles, // now [k, m]
     const std::shared_ptr<DeviceTensor<T>>& m_inv,
-    const std::shared_ptr<DeviceTensor<T>>& log2p_list,
-    const std::shared_ptr<DeviceTensor<T>>& mu_list,
-    std::shared_ptr<DeviceTensor<T>>& result
+    const std::shared_ptr<DeviceTensor<T>>& /*log2p_list*/,
+    const std::shared_ptr<DeviceTensor<T>>& /*mu_list*/,
+    std::shared_ptr<DeviceTensor<T>>& result,
+    bool skip_perm
 ) {
     int64_t l, m, r, k;
     validate_ntt_inputs<T>(a, p, perm, inv_twiddles, result, l, m, r, k);
 
-    for (int64_t i = 0; i < l; ++i) {
-        for (int64_t j = 0; j < r; ++j) {
-            for (int64_t t = 0; t < k; ++t) {
-                T mod = p->at({t});
-                T m_inv_t = m_inv->at({t});
-
-                for (int64_t u = 0; u < m; ++u) {
-                    int64_t pu = perm->at({u});
-                    result->at({i, pu, j, t}) = a->at({i, u, j, t});
-                }
-
-                int64_t n = m, t_stride = 1, half = n / 2;
-                while (half >= 1) {
-                    for (int64_t tid = 0; tid < n / 2; ++tid) {
-                        int64_t group = tid / t_stride;
-                        int64_t idx_u = group * t_stride * 2 + (tid % t_stride);
-                        int64_t idx_v = idx_u + t_stride;
-                        int64_t idx_psi = half + group;
-
-                        T u_val = result->at({i, idx_u, j, t});
-                        T v_val = result->at({i, idx_v, j, t});
-                        T s = inv_twiddles->at({t, idx_psi});
-
-                        result->at({i, idx_u, j, t}) = (u_val + v_val) % mod;
-                        T_DP<T> diff = static_cast<T_DP<T>>(u_val + mod - v_val) * static_cast<T_DP<T>>(s);
-                        result->at({i, idx_v, j, t}) = static_cast<T>(diff % static_cast<T_DP<T>>(mod));
-                    }
-                    t_stride *= 2;
-                    half /= 2;
-                }
-
-                for (int64_t u = 0; u < m; ++u) {
-                    T val = result->at({i, u, j, t});
-                    result->at({i, u, j, t}) = (val * m_inv_t) % mod;
-                }
-            }
-        }
-    }
+    auto table = get_shoup_twiddles<T>(p, inv_twiddles, k, m);
+    const std::vector<int64_t> perm_idx = skip_perm ? std::vector<int64_t>() : load_permutation<T>(perm, m);
+
+    run_intt<T>(*a, *table, make_inverse_fold<T>(*table, m_inv), skip_perm ? nullptr : perm_idx.data(),
+                *result);
+    result->montgomery = a->montgomery;
+}
+
+template <typename T>
+void ntt(
+    const std::shared_ptr<DeviceTensor<T>>& a,
+    const NttPlan<T>& plan,
+    std::shared_ptr<DeviceTensor<T>>& result,
+    bool skip_perm
+) {
+    const auto& tables = plan.tables();
+    validate_plan_inputs<T>(a, result, tables.m, tables.k);
+    if (!tables.forward)
+        throw std::invalid_argument("NttPlan was built without 'twiddles'.");
+    if (!skip_perm && tables.perm.empty())
+        throw std::invalid_argument("NttPlan was built without 'perm'; pass skip_perm.");
+
+    run_ntt<T>(*a, *tables.forward, skip_perm ? nullptr : tables.perm.data(), *result);
+    result->montgomery = a->montgomery;
+}
+
+template <typename T>
+void intt(
+    const std::shared_ptr<DeviceTensor<T>>& a,
+    const NttPlan<T>& plan,
+    std::shared_ptr<DeviceTensor<T>>& result,
+    bool skip_perm
+) {
+    const auto& tables = plan.tables();
+    validate_plan_inputs<T>(a, result, tables.m, tables.k);
+    if (!tables.inverse)
+        throw std::invalid_argument("NttPlan was built without 'inv_twiddles'.");
+    if (!skip_perm && tables.perm.empty())
+        throw std::invalid_argument("NttPlan was built without 'perm'; pass skip_perm.");
+
+    run_intt<T>(*a, *tables.inverse, tables.fold, skip_perm ? nullptr : tables.perm.data(), *result);
+    result->montgomery = a->montgomery;
 }
 
 // Explicit instantiations
@@ -179,7 +950,8 @@ template void ntt<int32_t>(
     const std::shared_ptr<DeviceTensor<int32_t>>& /*twiddles*/,
     const std::shared_ptr<DeviceTensor<int32_t>>& /*log2p_list*/,
     const std::shared_ptr<DeviceTensor<int32_t>>& /*mu_list*/,
-    std::shared_ptr<DeviceTensor<int32_t>>& /*result*/);
+    std::shared_ptr<DeviceTensor<int32_t>>& /*result*/,
+    bool /*skip_perm*/);
 
 template void ntt<int64_t>(
     const std::shared_ptr<DeviceTensor<int64_t>>& /*a*/,
@@ -188,7 +960,8 @@ template void ntt<int64_t>(
     const std::shared_ptr<DeviceTensor<int64_t>>& /*twiddles*/,
     const std::shared_ptr<DeviceTensor<int64_t>>& /*log2p_list*/,
     const std::shared_ptr<DeviceTensor<int64_t>>& /*mu_list*/,
-    std::shared_ptr<DeviceTensor<int64_t>>& /*result*/);
+    std::shared_ptr<DeviceTensor<int64_t>>& /*result*/,
+    bool /*skip_perm*/);
 
 template void intt<int32_t>(
     const std::shared_ptr<DeviceTensor<int32_t>>& /*a*/,
@@ -198,7 +971,8 @@ template void intt<int32_t>(
     const std::shared_ptr<DeviceTensor<int32_t>>& /*m_inv*/,
     const std::shared_ptr<DeviceTensor<int32_t>>& /*log2p_list*/,
     const std::shared_ptr<DeviceTensor<int32_t>>& /*mu_list*/,
-    std::shared_ptr<DeviceTensor<int32_t>>& /*result*/);
+    std::shared_ptr<DeviceTensor<int32_t>>& /*result*/,
+    bool /*skip_perm*/);
 
 template void intt<int64_t>(
     const std::shared_ptr<DeviceTensor<int64_t>>& /*a*/,
@@ -208,7 +982,25 @@ template void intt<int64_t>(
     const std::shared_ptr<DeviceTensor<int64_t>>& /*m_inv*/,
     const std::shared_ptr<DeviceTensor<int64_t>>& /*log2p_list*/,
     const std::shared_ptr<DeviceTensor<int64_t>>& /*mu_list*/,
-    std::shared_ptr<DeviceTensor<int64_t>>& /*result*/);
+    std::shared_ptr<DeviceTensor<int64_t>>& /*result*/,
+    bool /*skip_perm*/);
+
+
+template class NttPlan<int32_t>;
+template class NttPlan<int64_t>;
+
+template void ntt<int32_t>(const std::shared_ptr<DeviceTensor<int32_t>>& /*a*/,
+                           const NttPlan<int32_t>& /*plan*/,
+                           std::shared_ptr<DeviceTensor<int32_t>>& /*result*/, bool /*skip_perm*/);
+template void ntt<int64_t>(const std::shared_ptr<DeviceTensor<int64_t>>& /*a*/,
+                           const NttPlan<int64_t>& /*plan*/,
+                           std::shared_ptr<DeviceTensor<int64_t>>& /*result*/, bool /*skip_perm*/);
+template void intt<int32_t>(const std::shared_ptr<DeviceTensor<int32_t>>& /*a*/,
+                            const NttPlan<int32_t>& /*plan*/,
+                            std::shared_ptr<DeviceTensor<int32_t>>& /*result*/, bool /*skip_perm*/);
+template void intt<int64_t>(const std::shared_ptr<DeviceTensor<int64_t>>& /*a*/,
+                            const NttPlan<int64_t>& /*plan*/,
+                            std::shared_ptr<DeviceTensor<int64_t>>& /*result*/, bool /*skip_perm*/);
 
 
 } // namespace lattica_hw_api
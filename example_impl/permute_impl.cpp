@@ -33,6 +33,7 @@ void permute(
     if (perms->dims.size() != 2 || perms->dims[0] != l || perms->dims[1] != m) {
         throw std::invalid_argument("Perms must have shape [l, m] where l and m match a.shape at elementwise and perm axes.");
     }
+    result->montgomery = a->montgomery;
 
     // Generate coordinate iterator over all batch dimensions
     std::vector<int64_t> coord(ndim, 0);
@@ -27,6 +27,36 @@ void bind_modop_variants(py::module_& m, const std::string& suffix) {
           "Elementwise modular addition: ([...,k] + scalar) % [k]");
     m.def(("modsum_tcc_" + suffix).c_str(), &modsum_tcc<T>,
           "Elementwise modular addition: ([...,k] + scalar) % scalar");
+
+    // modmuladd variants
+    m.def(("modmuladd_ttt_" + suffix).c_str(), &modmuladd_ttt<T>,
+          "Fused modular multiply-add: ([...,k] * [...,k] + [...,k]) % [k]");
+    m.def(("modmuladd_ttc_" + suffix).c_str(), &modmuladd_ttc<T>,
+          "Fused modular multiply-add: ([...,k] * [...,k] + [...,k]) % scalar");
+    m.def(("modmuladd_tct_" + suffix).c_str(), &modmuladd_tct<T>,
+          "Fused modular multiply-add: ([...,k] * scalar + [...,k]) % [k]");
+    m.def(("modmuladd_tcc_" + suffix).c_str(), &modmuladd_tcc<T>,
+          "Fused modular multiply-add: ([...,k] * scalar + [...,k]) % scalar");
+
+    // modneg variants
+    m.def(("modneg_tt_" + suffix).c_str(), &modneg_tt<T>,
+          "Elementwise modular negation: (-[...,k]) % [k]");
+    m.def(("modneg_tc_" + suffix).c_str(), &modneg_tc<T>,
+          "Elementwise modular negation: (-[...,k]) % scalar");
+
+    // mod (remainder) variants
+    m.def(("mod_tt_" + suffix).c_str(), &mod_tt<T>,
+          "Elementwise remainder: [...] % [...]");
+    m.def(("mod_tc_" + suffix).c_str(), &mod_tc<T>,
+          "Elementwise remainder: [...] % scalar");
+    m.def(("mod_ct_" + suffix).c_str(), &mod_ct<T>,
+          "Elementwise remainder: scalar % [...]");
+
+    // Montgomery form
+    m.def(("to_montgomery_" + suffix).c_str(), &to_montgomery<T>,
+          "Convert to Montgomery form: ([...,k] * R) % [k]");
+    m.def(("from_montgomery_" + suffix).c_str(), &from_montgomery<T>,
+          "Convert from Montgomery form: ([...,k] * R^-1) % [k]");
 }
 
 template <typename T>
@@ -61,7 +91,10 @@ void bind_device_memory(py::module_& m, const std::string& suffix) {
     py::class_<DeviceMem, std::shared_ptr<DeviceMem>>(m, ("DeviceTensor" + suffix).c_str())
         .def("print", &DeviceMem::print)
         .def("print_metadata", &DeviceMem::print_metadata)
-        .def("reshape", &DeviceMem::reshape);
+        .def("reshape", &DeviceMem::reshape)
+        .def_property_readonly("montgomery", [](const std::shared_ptr<DeviceMem>& tensor) {
+            return lattica_hw_api::is_montgomery<T>(tensor);
+        });
 }
 
 template <typename T>
@@ -72,10 +105,13 @@ void bind_memory_helpers(py::module_& m, const std::string& suffix) {
           py::arg("dims"));
     m.def(("host_to_device_" + suffix).c_str(),
           &host_to_device<T>,
-          py::arg("tensor"));
+          py::arg("tensor"), py::arg("zero_copy") = false);
     m.def(("device_to_host_" + suffix).c_str(),
           &device_to_host<T>,
-          py::arg("device_mem"));
+          py::arg("device_mem"), py::arg("view") = false);
+    m.def(("numa_node_of_" + suffix).c_str(),
+          &numa_node_of<T>,
+          py::arg("device_mem"), "NUMA node holding most of the tensor's pages, or -1 if unknown");
 }
 
 template <typename T>
@@ -84,6 +120,56 @@ void bind_contiguous(py::module_& m, const std::string& suffix) {
           py::arg("tensor"), "Return a contiguous version of the tensor.");
 }
 
+template <typename T>
+void bind_ntt(py::module_& m, const std::string& suffix) {
+    using Tensor = std::shared_ptr<DeviceTensor<T>>;
+    using TensorTransform = void (*)(const Tensor&, const Tensor&, const Tensor&, const Tensor&,
+                                     const Tensor&, const Tensor&, Tensor&, bool);
+    using TensorInverse = void (*)(const Tensor&, const Tensor&, const Tensor&, const Tensor&,
+                                   const Tensor&, const Tensor&, const Tensor&, Tensor&, bool);
+    using PlanTransform = void (*)(const Tensor&, const NttPlan<T>&, Tensor&, bool);
+
+    py::class_<NttPlan<T>, std::shared_ptr<NttPlan<T>>>(m, ("NttPlan" + suffix).c_str())
+        .def(py::init<const Tensor&, const Tensor&, const Tensor&, const Tensor&, const Tensor&,
+                      const Tensor&, const Tensor&>(),
+             py::arg("p"), py::arg("perm"), py::arg("twiddles"), py::arg("inv_twiddles"),
+             py::arg("m_inv"), py::arg("log2p_list") = py::none(), py::arg("mu_list") = py::none(),
+             "Precomputed NTT/INTT tables for one transform length and set of moduli")
+        .def_property_readonly("m", &NttPlan<T>::m)
+        .def_property_readonly("k", &NttPlan<T>::k);
+
+    m.def(("ntt_" + suffix).c_str(), static_cast<TensorTransform>(&ntt<T>),
+          py::arg("a"), py::arg("p"), py::arg("perm"), py::arg("twiddles"),
+          py::arg("log2p_list"), py::arg("mu_list"), py::arg("result"),
+          py::arg("skip_perm") = false,
+          ("NTT (int" + suffix + ")").c_str());
+    m.def(("ntt_" + suffix).c_str(), static_cast<PlanTransform>(&ntt<T>),
+          py::arg("a"), py::arg("plan"), py::arg("result"), py::arg("skip_perm") = false,
+          ("NTT with a precomputed plan (int" + suffix + ")").c_str());
+    m.def(("intt_" + suffix).c_str(), static_cast<TensorInverse>(&intt<T>),
+          py::arg("a"), py::arg("p"), py::arg("perm"), py::arg("inv_twiddles"),
+          py::arg("m_inv"), py::arg("log2p_list"), py::arg("mu_list"), py::arg("result"),
+          py::arg("skip_perm") = false,
+          ("INTT (int" + suffix + ")").c_str());
+    m.def(("intt_" + suffix).c_str(), static_cast<PlanTransform>(&intt<T>),
+          py::arg("a"), py::arg("plan"), py::arg("result"), py::arg("skip_perm") = false,
+          ("INTT with a precomputed plan (int" + suffix + ")").c_str());
+}
+
+template <typename T>
+void bind_fused_modop(py::module_& m, const std::string& suffix) {
+    using Fused = FusedModop<T>;
+    py::class_<Fused, std::shared_ptr<Fused>>(m, ("FusedModop" + suffix).c_str())
+        .def(py::init<>(), "Empty elementwise modular expression graph")
+        .def("input", &Fused::input, py::arg("tensor"), "Add a tensor leaf; returns its node id")
+        .def("scalar", &Fused::scalar, py::arg("value"), "Add a scalar leaf; returns its node id")
+        .def("modsum", &Fused::modsum, py::arg("a"), py::arg("b"), py::arg("p"), "(a + b) % p")
+        .def("modmul", &Fused::modmul, py::arg("a"), py::arg("b"), py::arg("p"), "(a * b) % p")
+        .def("mod", &Fused::mod, py::arg("a"), py::arg("b"), "a % b")
+        .def("evaluate", &Fused::evaluate, py::arg("node"), py::arg("result"),
+             "Compute one node into result in a single pass");
+}
+
 PYBIND11_MODULE(lattica_hw, m) {
     m.doc() = "Lattica Hardware API Python bindings";
 
@@ -97,14 +183,74 @@ PYBIND11_MODULE(lattica_hw, m) {
     bind_memory_helpers<int64_t>(m, "64");
     bind_memory_helpers<double>(m, "float64");
 
+    // memory pool
+    py::class_<MemoryPoolStats>(m, "MemoryPoolStats")
+        .def_readonly("hits", &MemoryPoolStats::hits)
+        .def_readonly("misses", &MemoryPoolStats::misses)
+        .def_readonly("cached_bytes", &MemoryPoolStats::cached_bytes)
+        .def_readonly("live_bytes", &MemoryPoolStats::live_bytes)
+        .def_readonly("peak_live_bytes", &MemoryPoolStats::peak_live_bytes);
+    m.def("get_memory_pool_stats", &get_memory_pool_stats, "Hit / miss counters and byte totals of the buffer pool");
+    m.def("reset_memory_pool_stats", &reset_memory_pool_stats, "Zero the pool's hit / miss counters");
+    m.def("release_memory_pool_cache", &release_memory_pool_cache, "Free every cached buffer");
+    m.def("set_memory_pool_cache_limit", &set_memory_pool_cache_limit, py::arg("bytes"),
+          "Most bytes the pool's free lists may hold (0 disables caching)");
+    m.def("get_memory_pool_cache_limit", &get_memory_pool_cache_limit, "Current cache limit in bytes");
+    py::enum_<HugePageMode>(m, "HugePageMode")
+        .value("off", HugePageMode::off)
+        .value("transparent", HugePageMode::transparent)
+        .value("explicit_pages", HugePageMode::explicit_pages);
+    m.def("set_memory_pool_huge_pages", &set_memory_pool_huge_pages, py::arg("mode"),
+          py::arg("threshold_bytes") = int64_t(1) << 21,
+          "Huge-page mode for pool buffers of at least threshold_bytes");
+    m.def("get_memory_pool_huge_page_mode", &get_memory_pool_huge_page_mode, "Current huge-page mode");
+    m.def("get_memory_pool_huge_page_threshold", &get_memory_pool_huge_page_threshold,
+          "Smallest buffer in bytes that uses huge pages");
+    py::enum_<NumaPolicy>(m, "NumaPolicy")
+        .value("first_touch", NumaPolicy::first_touch)
+        .value("interleave", NumaPolicy::interleave)
+        .value("bind", NumaPolicy::bind);
+    m.def("numa_node_count", &numa_node_count, "Number of NUMA nodes (1 without libnuma)");
+    m.def("set_memory_pool_numa_policy", &set_memory_pool_numa_policy, py::arg("policy"),
+          py::arg("node") = -1, "NUMA placement of new pool buffers; node is the bind target");
+    m.def("get_memory_pool_numa_policy", &get_memory_pool_numa_policy, "Current NUMA placement policy");
+    m.def("get_memory_pool_numa_node", &get_memory_pool_numa_node, "Bind target node, or -1");
+
+    // memory plan
+    py::class_<BufferLifetime>(m, "BufferLifetime")
+        .def(py::init([](int64_t bytes, int64_t first, int64_t last) { return BufferLifetime{bytes, first, last}; }),
+             py::arg("bytes"), py::arg("first"), py::arg("last"))
+        .def_readonly("bytes", &BufferLifetime::bytes)
+        .def_readonly("first", &BufferLifetime::first)
+        .def_readonly("last", &BufferLifetime::last);
+    py::class_<MemoryPlan>(m, "MemoryPlan")
+        .def(py::init<const std::vector<BufferLifetime>&>(), py::arg("buffers"),
+             "Arena offsets for buffers alive over [first, last] steps")
+        .def_property_readonly("num_buffers", &MemoryPlan::num_buffers)
+        .def("offset", &MemoryPlan::offset, py::arg("buffer"))
+        .def_property_readonly("arena_bytes", &MemoryPlan::arena_bytes)
+        .def_property_readonly("max_live_bytes", &MemoryPlan::max_live_bytes);
+    m.def("begin_memory_plan", &begin_memory_plan, py::arg("plan"),
+          "Serve the following allocate_on_hardware calls from the plan's arena");
+    m.def("end_memory_plan", &end_memory_plan, "Return allocate_on_hardware to the pool");
+    m.def("memory_plan_position", &memory_plan_position, "Planned buffers handed out so far, or -1");
+
     // Bind modular ops
     bind_modop_variants<int32_t>(m, "32");
     bind_modop_variants<int64_t>(m, "64");
 
+    // fused elementwise expressions
+    bind_fused_modop<int32_t>(m, "32");
+    bind_fused_modop<int64_t>(m, "64");
+
     // axis_modsum
     m.def("axis_modsum_32", &axis_modsum<int32_t>, "Axis-wise modular sum (int32)");
     m.def("axis_modsum_64", &axis_modsum<int64_t>, "Axis-wise modular sum (int64)");
 
+    // modmul_axis_sum
+    m.def("modmul_axis_sum_32", &modmul_axis_sum<int32_t>, "Axis-wise modular inner product (int32)");
+    m.def("modmul_axis_sum_64", &modmul_axis_sum<int64_t>, "Axis-wise modular inner product (int64)");
+
     // g_decomposition
     bind_g_decomposition<int32_t>(m, "32");
     bind_g_decomposition<int64_t>(m, "64");
@@ -119,13 +265,14 @@ PYBIND11_MODULE(lattica_hw, m) {
     bind_contiguous<int64_t>(m, "64");
     bind_contiguous<double>(m, "float64");
 
-    // ntt
-    m.def("ntt_32", &ntt<int32_t>, "NTT (int32)");
-    m.def("ntt_64", &ntt<int64_t>, "NTT (int64)");
+    // ntt / intt
+    bind_ntt<int32_t>(m, "32");
+    bind_ntt<int64_t>(m, "64");
 
-    // intt
-    m.def("intt_32", &intt<int32_t>, "INTT (int32)");
-    m.def("intt_64", &intt<int64_t>, "INTT (int64)");
+    m.def("set_ntt_four_step_threshold", &set_ntt_four_step_threshold,
+          "Transform length from which ntt/intt use the cache-blocked four-step order (0 disables)");
+    m.def("get_ntt_four_step_threshold", &get_ntt_four_step_threshold,
+          "Current four-step threshold");
 
     // permute
     m.def("permute_32", &permute<int32_t>, "Permute (int32)");
@@ -0,0 +1,14 @@
+// Built with -mavx2; only reached after simd_level() reported SimdLevel::avx2 or better.
+#include "simd_kernels.h"
+#include "simd_ops.h"
+
+namespace lattica_hw_api {
+namespace simd {
+
+LATTICA_DEFINE_NTT_COLUMN_KERNELS(avx2, Avx2U32)
+LATTICA_DEFINE_NTT_COLUMN_KERNELS(avx2, Avx2U64)
+LATTICA_DEFINE_MODOP_CONTIGUOUS_KERNELS(avx2, Avx2U32)
+LATTICA_DEFINE_MODOP_CONTIGUOUS_KERNELS(avx2, Avx2U64)
+
+} // namespace simd
+} // namespace lattica_hw_api
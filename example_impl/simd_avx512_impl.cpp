@@ -0,0 +1,14 @@
+// Built with -mavx512f -mavx512dq; only reached after simd_level() reported SimdLevel::avx512.
+#include "simd_kernels.h"
+#include "simd_ops.h"
+
+namespace lattica_hw_api {
+namespace simd {
+
+LATTICA_DEFINE_NTT_COLUMN_KERNELS(avx512, Avx512U32)
+LATTICA_DEFINE_NTT_COLUMN_KERNELS(avx512, Avx512U64)
+LATTICA_DEFINE_MODOP_CONTIGUOUS_KERNELS(avx512, Avx512U32)
+LATTICA_DEFINE_MODOP_CONTIGUOUS_KERNELS(avx512, Avx512U64)
+
+} // namespace simd
+} // namespace lattica_hw_api
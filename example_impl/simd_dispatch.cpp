@@ -0,0 +1,35 @@
+#include "simd_dispatch.h"
+
+#include <cstdlib>
+#include <cstring>
+
+namespace lattica_hw_api {
+
+namespace {
+
+SimdLevel detect_cpu_simd_level() {
+#if defined(LATTICA_X86_SIMD)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512dq"))
+        return SimdLevel::avx512;
+    if (__builtin_cpu_supports("avx2"))
+        return SimdLevel::avx2;
+#endif
+    return SimdLevel::scalar;
+}
+
+} // namespace
+
+SimdLevel simd_level() {
+    static const SimdLevel cpu_level = detect_cpu_simd_level();
+
+    SimdLevel requested = cpu_level;
+    if (const char* env = std::getenv("LATTICA_SIMD")) {
+        if (std::strcmp(env, "scalar") == 0) requested = SimdLevel::scalar;
+        else if (std::strcmp(env, "avx2") == 0) requested = SimdLevel::avx2;
+        else if (std::strcmp(env, "avx512") == 0) requested = SimdLevel::avx512;
+    }
+    return requested < cpu_level ? requested : cpu_level;
+}
+
+} // namespace lattica_hw_api
@@ -0,0 +1,48 @@
+#ifndef SIMD_DISPATCH_H
+#define SIMD_DISPATCH_H
+
+#include <cstdint>
+
+/**
+ * @brief Runtime selection of the vectorized kernel variants.
+ *
+ * The AVX2 / AVX-512 kernels are compiled into their own translation units with the
+ * matching instruction-set flags and are only called when the running CPU supports
+ * them. Everything else in the library stays baseline x86-64 (or non-x86) code.
+ */
+
+namespace lattica_hw_api {
+
+enum class SimdLevel {
+    scalar = 0,
+    avx2 = 1,
+    avx512 = 2,
+};
+
+/**
+ * @brief Widest instruction set the vectorized kernels may use.
+ *
+ * Detected once via CPUID. The LATTICA_SIMD environment variable ("scalar", "avx2" or
+ * "avx512") can lower the level, e.g. to exercise the fallback paths; it is never
+ * raised above what the CPU supports.
+ */
+SimdLevel simd_level();
+
+/**
+ * @brief Number of T elements in one vector register at the given level.
+ */
+template <typename T>
+constexpr int64_t simd_lanes(SimdLevel level) {
+    return level == SimdLevel::avx512 ? 64 / static_cast<int64_t>(sizeof(T))
+         : level == SimdLevel::avx2   ? 32 / static_cast<int64_t>(sizeof(T))
+         : 1;
+}
+
+/**
+ * @brief Largest lane count of any level, used to size lane-replicated tables.
+ */
+constexpr int64_t max_simd_lanes = 16;
+
+} // namespace lattica_hw_api
+
+#endif // SIMD_DISPATCH_H
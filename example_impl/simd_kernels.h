@@ -0,0 +1,99 @@
+#ifndef SIMD_KERNELS_H
+#define SIMD_KERNELS_H
+
+#include "simd_dispatch.h"
+
+#include <cstdint>
+
+/**
+ * @brief Entry points of the instruction-set specific kernels.
+ *
+ * Each `_avx2` / `_avx512` function lives in a translation unit built with the matching
+ * -m flags (simd_avx2_impl.cpp, simd_avx512_impl.cpp) and must only be called after
+ * simd_level() reported that level. They are compiled only when LATTICA_X86_SIMD is set.
+ *
+ * The NTT kernels work on `lanes` independent columns of a row-major [m, row_stride]
+ * block: column c is the sequence x[u * row_stride + c] and uses modulus mod[c] and
+ * twiddles w[idx * tw_stride + c] with Shoup companions w_shoup[idx * tw_stride + c].
+ * `lanes` must be a multiple of simd_lanes<T>() for the level; the caller handles any
+ * remaining columns with the scalar kernels. Moduli must be below lazy_modulus_bound.
+ *
+ *  - ntt_column_stages / intt_column_stages: the lane-wise ntt_stages_shoup /
+ *    intt_stages_shoup of ntt_impl.cpp over an n-point block (values in [0, 4p) and
+ *    [0, 2p) respectively), with twiddle index stage * root + group.
+ *    intt_column_stages takes an optional `fold` table ([4, tw_stride]: m^-1, its
+ *    companion, w[root] * m^-1, its companion) that folds the m^-1 scaling into the
+ *    last stage and leaves the block in [0, p).
+ *  - ntt_column_reduce: [0, 4p) -> [0, p) over m rows.
+ *
+ * The contiguous modop kernels process `count` elements, a multiple of simd_lanes<T>():
+ * r[i] = (a[i] + b[i * b_step]) % p[i] or (a[i] * b[i * b_step]) % p[i], where b_step is
+ * 1 or 0 (scalar b) and p, mu, log2p hold each element's modulus and Barrett constants
+ * (see BarrettReducer; modmul requires 2 <= p < 2^(bits - 2)). Elements with an operand
+ * outside [0, p) get modop's signed `%` result. `r` may alias `a` or `b`.
+ * modmuladd_contiguous computes (a[i] * b[i * b_step] + c[i]) % p[i] the same way, with
+ * a dense addend c that `r` may also alias.
+ * modneg_contiguous computes -a[i] mod p[i] in [0, p), for any a[i].
+ * montmul_contiguous computes the Montgomery product a[i] * b[i * b_step] * R^-1 % p[i]
+ * (R = 2^bits) with p_inv[i] = p[i]^-1 mod R, for odd moduli; operands outside [0, p) are
+ * reduced to their residues first.
+ */
+
+namespace lattica_hw_api {
+namespace simd {
+
+#if defined(LATTICA_X86_SIMD)
+
+#define LATTICA_DECLARE_NTT_COLUMNS(ISA, WORD)                                              \
+    void ntt_column_stages_##ISA(WORD* x, int64_t row_stride, int64_t n, int64_t root,      \
+                                 int64_t lanes, const WORD* w, const WORD* w_shoup,         \
+                                 int64_t tw_stride, const WORD* mod);                       \
+    void ntt_column_reduce_##ISA(WORD* x, int64_t row_stride, int64_t m, int64_t lanes,     \
+                                 const WORD* mod);                                          \
+    void intt_column_stages_##ISA(WORD* x, int64_t row_stride, int64_t n, int64_t root,     \
+                                  int64_t lanes, const WORD* w, const WORD* w_shoup,        \
+                                  int64_t tw_stride, const WORD* mod, const WORD* fold);
+
+LATTICA_DECLARE_NTT_COLUMNS(avx2, uint32_t)
+LATTICA_DECLARE_NTT_COLUMNS(avx2, uint64_t)
+LATTICA_DECLARE_NTT_COLUMNS(avx512, uint32_t)
+LATTICA_DECLARE_NTT_COLUMNS(avx512, uint64_t)
+
+#undef LATTICA_DECLARE_NTT_COLUMNS
+
+#define LATTICA_DECLARE_MODOP_CONTIGUOUS(ISA, WORD)                                         \
+    void modsum_contiguous_##ISA(WORD* r, const WORD* a, const WORD* b, int64_t b_step,     \
+                                 int64_t count, const WORD* p);                             \
+    void modneg_contiguous_##ISA(WORD* r, const WORD* a, int64_t count, const WORD* p);     \
+    void modmul_contiguous_##ISA(WORD* r, const WORD* a, const WORD* b, int64_t b_step,     \
+                                 int64_t count, const WORD* p, const WORD* mu,              \
+                                 const WORD* log2p);                                        \
+    void modmuladd_contiguous_##ISA(WORD* r, const WORD* a, const WORD* b, int64_t b_step,  \
+                                    const WORD* c, int64_t count, const WORD* p,            \
+                                    const WORD* mu, const WORD* log2p);                     \
+    void montmul_contiguous_##ISA(WORD* r, const WORD* a, const WORD* b, int64_t b_step,    \
+                                  int64_t count, const WORD* p, const WORD* p_inv);
+
+LATTICA_DECLARE_MODOP_CONTIGUOUS(avx2, uint32_t)
+LATTICA_DECLARE_MODOP_CONTIGUOUS(avx2, uint64_t)
+LATTICA_DECLARE_MODOP_CONTIGUOUS(avx512, uint32_t)
+LATTICA_DECLARE_MODOP_CONTIGUOUS(avx512, uint64_t)
+
+#undef LATTICA_DECLARE_MODOP_CONTIGUOUS
+
+// Calls simd::NAME_avx512 or simd::NAME_avx2 for a level other than SimdLevel::scalar.
+#define LATTICA_SIMD_CALL(level, NAME, ...)                                                 \
+    ((level) == ::lattica_hw_api::SimdLevel::avx512                                         \
+         ? ::lattica_hw_api::simd::NAME##_avx512(__VA_ARGS__)                               \
+         : ::lattica_hw_api::simd::NAME##_avx2(__VA_ARGS__))
+
+#else
+
+#define LATTICA_SIMD_CALL(level, NAME, ...) ((void)(level))
+
+#endif // LATTICA_X86_SIMD
+
+} // namespace simd
+} // namespace lattica_hw_api
+
+#endif // SIMD_KERNELS_H
@@ -0,0 +1,603 @@
+#ifndef SIMD_OPS_H
+#define SIMD_OPS_H
+
+#include "mod_arith.h"
+#include "typing.h"
+
+#include <cstdint>
+#include <immintrin.h>
+#include <type_traits>
+
+/**
+ * @brief Vector-width policies and the generic kernels built on them.
+ *
+ * Only included by the instruction-set specific translation units. Each policy wraps
+ * one register type and exposes the handful of unsigned-lane operations the kernels
+ * need; the kernels are written once against that interface. Everything here has
+ * internal linkage, so code compiled with -mavx2 / -mavx512f can never be picked by
+ * the linker for a baseline translation unit.
+ */
+
+namespace lattica_hw_api {
+namespace simd {
+namespace {
+
+#if defined(__AVX2__)
+
+struct Avx2U32 {
+    using word = uint32_t;
+    using vec = __m256i;
+    static constexpr int64_t lanes = 8;
+
+    static vec load(const word* p) { return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)); }
+    static void store(word* p, vec v) { _mm256_storeu_si256(reinterpret_cast<__m256i*>(p), v); }
+    static vec add(vec a, vec b) { return _mm256_add_epi32(a, b); }
+    static vec sub(vec a, vec b) { return _mm256_sub_epi32(a, b); }
+    static vec set1(word v) { return _mm256_set1_epi32(static_cast<int32_t>(v)); }
+    static vec bit_or(vec a, vec b) { return _mm256_or_si256(a, b); }
+    static vec shr(vec a, vec count) { return _mm256_srlv_epi32(a, count); }
+    static vec shl(vec a, vec count) { return _mm256_sllv_epi32(a, count); }
+    // Every lane a < b (unsigned), compared as signed with the sign bits flipped.
+    static bool all_less(vec a, vec b) {
+        const vec sign = _mm256_set1_epi32(INT32_MIN);
+        vec lt = _mm256_cmpgt_epi32(_mm256_xor_si256(b, sign), _mm256_xor_si256(a, sign));
+        return _mm256_movemask_epi8(lt) == -1;
+    }
+    // a >= b ? a - b : a; a - b wraps above a exactly when a < b.
+    static vec csub(vec a, vec b) { return _mm256_min_epu32(a, _mm256_sub_epi32(a, b)); }
+    static vec mullo(vec a, vec b) { return _mm256_mullo_epi32(a, b); }
+    static vec mulhi(vec a, vec b) {
+        vec even = _mm256_mul_epu32(a, b);
+        vec odd = _mm256_mul_epu32(_mm256_srli_epi64(a, 32), _mm256_srli_epi64(b, 32));
+        return _mm256_blend_epi32(_mm256_srli_epi64(even, 32), odd, 0xAA);
+    }
+};
+
+struct Avx2U64 {
+    using word = uint64_t;
+    using vec = __m256i;
+    static constexpr int64_t lanes = 4;
+
+    static vec load(const word* p) { return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)); }
+    static void store(word* p, vec v) { _mm256_storeu_si256(reinterpret_cast<__m256i*>(p), v); }
+    static vec add(vec a, vec b) { return _mm256_add_epi64(a, b); }
+    static vec sub(vec a, vec b) { return _mm256_sub_epi64(a, b); }
+    static vec set1(word v) { return _mm256_set1_epi64x(static_cast<int64_t>(v)); }
+    static vec bit_or(vec a, vec b) { return _mm256_or_si256(a, b); }
+    static vec shr(vec a, vec count) { return _mm256_srlv_epi64(a, count); }
+    static vec shl(vec a, vec count) { return _mm256_sllv_epi64(a, count); }
+    // No unsigned 64-bit compare in AVX2: flip the sign bits and compare signed.
+    static bool all_less(vec a, vec b) {
+        const vec sign = _mm256_set1_epi64x(INT64_MIN);
+        vec lt = _mm256_cmpgt_epi64(_mm256_xor_si256(b, sign), _mm256_xor_si256(a, sign));
+        return _mm256_movemask_epi8(lt) == -1;
+    }
+    static vec csub(vec a, vec b) {
+        const vec sign = _mm256_set1_epi64x(INT64_MIN);
+        vec a_lt_b = _mm256_cmpgt_epi64(_mm256_xor_si256(b, sign), _mm256_xor_si256(a, sign));
+        return _mm256_blendv_epi8(_mm256_sub_epi64(a, b), a, a_lt_b);
+    }
+    static vec mullo(vec a, vec b) {
+        vec cross = _mm256_add_epi64(_mm256_mul_epu32(_mm256_srli_epi64(a, 32), b),
+                                     _mm256_mul_epu32(a, _mm256_srli_epi64(b, 32)));
+        return _mm256_add_epi64(_mm256_mul_epu32(a, b), _mm256_slli_epi64(cross, 32));
+    }
+    // Schoolbook 64x64 -> high 64 from four 32x32 -> 64 products.
+    static vec mulhi(vec a, vec b) {
+        const vec low_mask = _mm256_set1_epi64x(0xffffffff);
+        vec a_hi = _mm256_srli_epi64(a, 32);
+        vec b_hi = _mm256_srli_epi64(b, 32);
+        vec lo_lo = _mm256_mul_epu32(a, b);
+        vec lo_hi = _mm256_mul_epu32(a, b_hi);
+        vec hi_lo = _mm256_mul_epu32(a_hi, b);
+        vec hi_hi = _mm256_mul_epu32(a_hi, b_hi);
+        vec mid = _mm256_add_epi64(_mm256_add_epi64(_mm256_srli_epi64(lo_lo, 32),
+                                                    _mm256_and_si256(lo_hi, low_mask)),
+                                   _mm256_and_si256(hi_lo, low_mask));
+        return _mm256_add_epi64(_mm256_add_epi64(hi_hi, _mm256_srli_epi64(mid, 32)),
+                                _mm256_add_epi64(_mm256_srli_epi64(lo_hi, 32),
+                                                 _mm256_srli_epi64(hi_lo, 32)));
+    }
+};
+
+#endif // __AVX2__
+
+#if defined(__AVX512F__) && defined(__AVX512DQ__)
+
+struct Avx512U32 {
+    using word = uint32_t;
+    using vec = __m512i;
+    static constexpr int64_t lanes = 16;
+
+    static vec load(const word* p) { return _mm512_loadu_si512(p); }
+    static void store(word* p, vec v) { _mm512_storeu_si512(p, v); }
+    static vec add(vec a, vec b) { return _mm512_add_epi32(a, b); }
+    static vec sub(vec a, vec b) { return _mm512_sub_epi32(a, b); }
+    static vec set1(word v) { return _mm512_set1_epi32(static_cast<int32_t>(v)); }
+    static vec bit_or(vec a, vec b) { return _mm512_or_si512(a, b); }
+    static vec shr(vec a, vec count) { return _mm512_srlv_epi32(a, count); }
+    static vec shl(vec a, vec count) { return _mm512_sllv_epi32(a, count); }
+    static bool all_less(vec a, vec b) { return _mm512_cmplt_epu32_mask(a, b) == 0xFFFF; }
+    static vec csub(vec a, vec b) { return _mm512_min_epu32(a, _mm512_sub_epi32(a, b)); }
+    static vec mullo(vec a, vec b) { return _mm512_mullo_epi32(a, b); }
+    static vec mulhi(vec a, vec b) {
+        vec even = _mm512_mul_epu32(a, b);
+        vec odd = _mm512_mul_epu32(_mm512_srli_epi64(a, 32), _mm512_srli_epi64(b, 32));
+        return _mm512_mask_blend_epi32(0xAAAA, _mm512_srli_epi64(even, 32), odd);
+    }
+};
+
+struct Avx512U64 {
+    using word = uint64_t;
+    using vec = __m512i;
+    static constexpr int64_t lanes = 8;
+
+    static vec load(const word* p) { return _mm512_loadu_si512(p); }
+    static void store(word* p, vec v) { _mm512_storeu_si512(p, v); }
+    static vec add(vec a, vec b) { return _mm512_add_epi64(a, b); }
+    static vec sub(vec a, vec b) { return _mm512_sub_epi64(a, b); }
+    static vec set1(word v) { return _mm512_set1_epi64(static_cast<int64_t>(v)); }
+    static vec bit_or(vec a, vec b) { return _mm512_or_si512(a, b); }
+    static vec shr(vec a, vec count) { return _mm512_srlv_epi64(a, count); }
+    static vec shl(vec a, vec count) { return _mm512_sllv_epi64(a, count); }
+    static bool all_less(vec a, vec b) { return _mm512_cmplt_epu64_mask(a, b) == 0xFF; }
+    static vec csub(vec a, vec b) { return _mm512_min_epu64(a, _mm512_sub_epi64(a, b)); }
+    static vec mullo(vec a, vec b) { return _mm512_mullo_epi64(a, b); }
+    static vec mulhi(vec a, vec b) {
+        const vec low_mask = _mm512_set1_epi64(0xffffffff);
+        vec a_hi = _mm512_srli_epi64(a, 32);
+        vec b_hi = _mm512_srli_epi64(b, 32);
+        vec lo_lo = _mm512_mul_epu32(a, b);
+        vec lo_hi = _mm512_mul_epu32(a, b_hi);
+        vec hi_lo = _mm512_mul_epu32(a_hi, b);
+        vec hi_hi = _mm512_mul_epu32(a_hi, b_hi);
+        vec mid = _mm512_add_epi64(_mm512_add_epi64(_mm512_srli_epi64(lo_lo, 32),
+                                                    _mm512_and_si512(lo_hi, low_mask)),
+                                   _mm512_and_si512(hi_lo, low_mask));
+        return _mm512_add_epi64(_mm512_add_epi64(hi_hi, _mm512_srli_epi64(mid, 32)),
+                                _mm512_add_epi64(_mm512_srli_epi64(lo_hi, 32),
+                                                 _mm512_srli_epi64(hi_lo, 32)));
+    }
+};
+
+#endif // __AVX512F__ && __AVX512DQ__
+
+// Lane-wise counterpart of shoup_mul_lazy in mod_arith.h: x * w mod p in [0, 2p).
+template <typename Ops>
+inline typename Ops::vec shoup_mul_lazy(typename Ops::vec x, typename Ops::vec w,
+                                        typename Ops::vec w_shoup, typename Ops::vec p) {
+    typename Ops::vec q = Ops::mulhi(x, w_shoup);
+    return Ops::sub(Ops::mullo(x, w), Ops::mullo(q, p));
+}
+
+// Lane-wise ct_butterfly_shoup: (a, b) in [0, 4p) -> (a + wb, a - wb) in [0, 4p).
+template <typename Ops>
+inline void ct_butterfly(typename Ops::vec& a, typename Ops::vec& b, typename Ops::vec s,
+                         typename Ops::vec s_shoup, typename Ops::vec p,
+                         typename Ops::vec two_p) {
+    typename Ops::vec u_val = Ops::csub(a, two_p);
+    typename Ops::vec v_val = shoup_mul_lazy<Ops>(b, s, s_shoup, p);
+    a = Ops::add(u_val, v_val);
+    b = Ops::sub(Ops::add(u_val, two_p), v_val);
+}
+
+// Lane-wise gs_butterfly_shoup: (a, b) in [0, 2p) -> (a + b, (a - b) w) in [0, 2p).
+template <typename Ops>
+inline void gs_butterfly(typename Ops::vec& a, typename Ops::vec& b, typename Ops::vec s,
+                         typename Ops::vec s_shoup, typename Ops::vec p,
+                         typename Ops::vec two_p) {
+    typename Ops::vec diff = Ops::sub(Ops::add(a, two_p), b);
+    a = Ops::csub(Ops::add(a, b), two_p);
+    b = shoup_mul_lazy<Ops>(diff, s, s_shoup, p);
+}
+
+// Lane-wise gs_butterfly_shoup_scaled: the last butterfly with m^-1 folded into its
+// twiddles, (a, b) in [0, 2p) -> ((a + b) m^-1, (a - b) w m^-1) in [0, p).
+template <typename Ops>
+inline void gs_butterfly_scaled(typename Ops::vec& a, typename Ops::vec& b,
+                                const typename Ops::vec* fold, typename Ops::vec p,
+                                typename Ops::vec two_p) {
+    typename Ops::vec diff = Ops::sub(Ops::add(a, two_p), b);
+    a = Ops::csub(shoup_mul_lazy<Ops>(Ops::add(a, b), fold[0], fold[1], p), p);
+    b = Ops::csub(shoup_mul_lazy<Ops>(diff, fold[2], fold[3], p), p);
+}
+
+// Lane-wise ntt_stages_shoup (ntt_impl.cpp): Harvey butterflies kept in [0, 4p) over an
+// n-point block, one vector of columns at a time, two stages per radix-4 sweep and a
+// radix-2 tail for odd log2(n).
+template <typename Ops>
+void ntt_column_stages(typename Ops::word* x, int64_t row_stride, int64_t n, int64_t root,
+                       int64_t lanes, const typename Ops::word* w,
+                       const typename Ops::word* w_shoup, int64_t tw_stride,
+                       const typename Ops::word* mod) {
+    using word = typename Ops::word;
+    using vec = typename Ops::vec;
+
+    for (int64_t c = 0; c < lanes; c += Ops::lanes) {
+        word* xc = x + c;
+        const vec p = Ops::load(mod + c);
+        const vec two_p = Ops::add(p, p);
+
+        int64_t stage = 1;
+        for (; 4 * stage <= n; stage *= 4) {
+            const int64_t quarter = n / (4 * stage);
+            for (int64_t u = 0; u < stage; ++u) {
+                word* x0 = xc + 4 * u * quarter * row_stride;
+                word* x1 = x0 + quarter * row_stride;
+                word* x2 = x1 + quarter * row_stride;
+                word* x3 = x2 + quarter * row_stride;
+                const int64_t i1 = (stage * root + u) * tw_stride + c;
+                const int64_t i2 = (2 * stage * root + 2 * u) * tw_stride + c;
+                const vec s1 = Ops::load(w + i1), s1_shoup = Ops::load(w_shoup + i1);
+                const vec s2 = Ops::load(w + i2), s2_shoup = Ops::load(w_shoup + i2);
+                const vec s3 = Ops::load(w + i2 + tw_stride);
+                const vec s3_shoup = Ops::load(w_shoup + i2 + tw_stride);
+
+                for (int64_t jx = 0; jx < quarter * row_stride; jx += row_stride) {
+                    vec a0 = Ops::load(x0 + jx), a1 = Ops::load(x1 + jx);
+                    vec a2 = Ops::load(x2 + jx), a3 = Ops::load(x3 + jx);
+                    ct_butterfly<Ops>(a0, a2, s1, s1_shoup, p, two_p);
+                    ct_butterfly<Ops>(a1, a3, s1, s1_shoup, p, two_p);
+                    ct_butterfly<Ops>(a0, a1, s2, s2_shoup, p, two_p);
+                    ct_butterfly<Ops>(a2, a3, s3, s3_shoup, p, two_p);
+                    Ops::store(x0 + jx, a0);
+                    Ops::store(x1 + jx, a1);
+                    Ops::store(x2 + jx, a2);
+                    Ops::store(x3 + jx, a3);
+                }
+            }
+        }
+
+        if (stage < n) {
+            const int64_t step = n / (2 * stage);
+            for (int64_t u = 0; u < stage; ++u) {
+                word* x1 = xc + 2 * u * step * row_stride;
+                word* x2 = x1 + step * row_stride;
+                const vec s = Ops::load(w + (stage * root + u) * tw_stride + c);
+                const vec s_shoup = Ops::load(w_shoup + (stage * root + u) * tw_stride + c);
+
+                for (int64_t jx = 0; jx < step * row_stride; jx += row_stride) {
+                    vec a = Ops::load(x1 + jx), b = Ops::load(x2 + jx);
+                    ct_butterfly<Ops>(a, b, s, s_shoup, p, two_p);
+                    Ops::store(x1 + jx, a);
+                    Ops::store(x2 + jx, b);
+                }
+            }
+        }
+    }
+}
+
+// [0, 4p) -> [0, p) over m rows.
+template <typename Ops>
+void ntt_column_reduce(typename Ops::word* x, int64_t row_stride, int64_t m, int64_t lanes,
+                       const typename Ops::word* mod) {
+    using vec = typename Ops::vec;
+
+    for (int64_t c = 0; c < lanes; c += Ops::lanes) {
+        const vec p = Ops::load(mod + c);
+        const vec two_p = Ops::add(p, p);
+        for (int64_t u = 0; u < m * row_stride; u += row_stride) {
+            Ops::store(x + c + u, Ops::csub(Ops::csub(Ops::load(x + c + u), two_p), p));
+        }
+    }
+}
+
+// Lane-wise intt_stages_shoup (ntt_impl.cpp): Gentleman-Sande butterflies kept in [0, 2p),
+// radix-4 sweeps with a radix-2 tail like ntt_column_stages. A non-null `fold` ([4, tw_stride]
+// rows m^-1, m^-1', w m^-1, (w m^-1)') folds the m^-1 scaling into the last stage.
+template <typename Ops>
+void intt_column_stages(typename Ops::word* x, int64_t row_stride, int64_t n, int64_t root,
+                        int64_t lanes, const typename Ops::word* w,
+                        const typename Ops::word* w_shoup, int64_t tw_stride,
+                        const typename Ops::word* mod, const typename Ops::word* fold) {
+    using word = typename Ops::word;
+    using vec = typename Ops::vec;
+
+    for (int64_t c = 0; c < lanes; c += Ops::lanes) {
+        word* xc = x + c;
+        const vec p = Ops::load(mod + c);
+        const vec two_p = Ops::add(p, p);
+        vec scale[4];
+        if (fold) {
+            for (int64_t e = 0; e < 4; ++e) scale[e] = Ops::load(fold + e * tw_stride + c);
+        }
+
+        int64_t t_stride = 1;
+        int64_t half = n / 2;
+        for (; half >= 2; half /= 4, t_stride *= 4) {
+            const bool scaled = fold && half == 2;
+            for (int64_t group = 0; group < half / 2; ++group) {
+                word* x0 = xc + group * t_stride * 4 * row_stride;
+                word* x1 = x0 + t_stride * row_stride;
+                word* x2 = x1 + t_stride * row_stride;
+                word* x3 = x2 + t_stride * row_stride;
+                const int64_t i1 = (half * root + 2 * group) * tw_stride + c;
+                const int64_t i3 = ((half / 2) * root + group) * tw_stride + c;
+                const vec s1 = Ops::load(w + i1), s1_shoup = Ops::load(w_shoup + i1);
+                const vec s2 = Ops::load(w + i1 + tw_stride);
+                const vec s2_shoup = Ops::load(w_shoup + i1 + tw_stride);
+                const vec s3 = Ops::load(w + i3), s3_shoup = Ops::load(w_shoup + i3);
+
+                for (int64_t jx = 0; jx < t_stride * row_stride; jx += row_stride) {
+                    vec a0 = Ops::load(x0 + jx), a1 = Ops::load(x1 + jx);
+                    vec a2 = Ops::load(x2 + jx), a3 = Ops::load(x3 + jx);
+                    gs_butterfly<Ops>(a0, a1, s1, s1_shoup, p, two_p);
+                    gs_butterfly<Ops>(a2, a3, s2, s2_shoup, p, two_p);
+                    if (scaled) {
+                        gs_butterfly_scaled<Ops>(a0, a2, scale, p, two_p);
+                        gs_butterfly_scaled<Ops>(a1, a3, scale, p, two_p);
+                    } else {
+                        gs_butterfly<Ops>(a0, a2, s3, s3_shoup, p, two_p);
+                        gs_butterfly<Ops>(a1, a3, s3, s3_shoup, p, two_p);
+                    }
+                    Ops::store(x0 + jx, a0);
+                    Ops::store(x1 + jx, a1);
+                    Ops::store(x2 + jx, a2);
+                    Ops::store(x3 + jx, a3);
+                }
+            }
+        }
+
+        if (half == 1) {
+            const vec s = Ops::load(w + root * tw_stride + c);
+            const vec s_shoup = Ops::load(w_shoup + root * tw_stride + c);
+            word* x2 = xc + t_stride * row_stride;
+            for (int64_t jx = 0; jx < t_stride * row_stride; jx += row_stride) {
+                vec a = Ops::load(xc + jx), b = Ops::load(x2 + jx);
+                if (fold) gs_butterfly_scaled<Ops>(a, b, scale, p, two_p);
+                else gs_butterfly<Ops>(a, b, s, s_shoup, p, two_p);
+                Ops::store(xc + jx, a);
+                Ops::store(x2 + jx, b);
+            }
+        }
+    }
+}
+
+// Lane-wise BarrettReducer::mul (mod_arith.h) with per-lane moduli: a * b mod p for
+// a, b < p < 2^(bits - 2). With n = log2p + 1, the double-word product is shifted right
+// by n - 1, multiplied by mu = ⌊2²ⁿ / p⌋ and shifted right by n + 1 (both shifts span
+// the word boundary), leaving a remainder in [0, 3p).
+template <typename Ops>
+inline typename Ops::vec barrett_mul(typename Ops::vec a, typename Ops::vec b,
+                                     typename Ops::vec p, typename Ops::vec mu,
+                                     typename Ops::vec log2p) {
+    using vec = typename Ops::vec;
+    const vec bits = Ops::set1(sizeof(typename Ops::word) * 8);
+    const vec lo_shift = log2p;
+    const vec q_shift = Ops::add(log2p, Ops::set1(2));
+
+    const vec x_lo = Ops::mullo(a, b), x_hi = Ops::mulhi(a, b);
+    const vec y = Ops::bit_or(Ops::shr(x_lo, lo_shift), Ops::shl(x_hi, Ops::sub(bits, lo_shift)));
+    const vec q = Ops::bit_or(Ops::shr(Ops::mullo(y, mu), q_shift),
+                              Ops::shl(Ops::mulhi(y, mu), Ops::sub(bits, q_shift)));
+    const vec r = Ops::sub(x_lo, Ops::mullo(q, p));
+    return Ops::csub(Ops::csub(r, p), p);
+}
+
+// modop's reference semantics, (a + b) % p or (a * b) % p in signed double width, for
+// the vectors of a contiguous run that hold an operand outside [0, p).
+template <typename Ops, bool Mul>
+void modop_exact(typename Ops::word* r, const typename Ops::word* a,
+                 const typename Ops::word* b, int64_t b_step, const typename Ops::word* p,
+                 int64_t count) {
+    using word = typename Ops::word;
+    using S = std::make_signed_t<word>;
+    for (int64_t i = 0; i < count; ++i) {
+        const T_DP<S> x = static_cast<S>(a[i]);
+        const T_DP<S> y = static_cast<S>(b[i * b_step]);
+        const T_DP<S> v = Mul ? x * y : x + y;
+        r[i] = static_cast<word>(static_cast<S>(v % static_cast<S>(p[i])));
+    }
+}
+
+// Contiguous modsum / modmul over `count` elements (a multiple of Ops::lanes): element i
+// reads a[i] and b[i * b_step] (b_step 0 broadcasts a scalar) and uses modulus p[i], with
+// Barrett constants mu[i] / log2p[i] for the product. Vectors whose operands are all in
+// [0, p) take the add + conditional subtract / Barrett path, others fall back to
+// modop_exact. `r` may alias `a` or `b`.
+template <typename Ops>
+void modsum_contiguous(typename Ops::word* r, const typename Ops::word* a,
+                       const typename Ops::word* b, int64_t b_step, int64_t count,
+                       const typename Ops::word* p) {
+    using vec = typename Ops::vec;
+    const vec b_scalar = Ops::set1(b[0]);
+
+    for (int64_t i = 0; i < count; i += Ops::lanes) {
+        const vec x = Ops::load(a + i);
+        const vec y = b_step ? Ops::load(b + i) : b_scalar;
+        const vec q = Ops::load(p + i);
+        if (Ops::all_less(x, q) && Ops::all_less(y, q)) {
+            Ops::store(r + i, Ops::csub(Ops::add(x, y), q));
+        } else {
+            modop_exact<Ops, false>(r + i, a + i, b + i * b_step, b_step, p + i, Ops::lanes);
+        }
+    }
+}
+
+template <typename Ops>
+void modmul_contiguous(typename Ops::word* r, const typename Ops::word* a,
+                       const typename Ops::word* b, int64_t b_step, int64_t count,
+                       const typename Ops::word* p, const typename Ops::word* mu,
+                       const typename Ops::word* log2p) {
+    using vec = typename Ops::vec;
+    const vec b_scalar = Ops::set1(b[0]);
+
+    for (int64_t i = 0; i < count; i += Ops::lanes) {
+        const vec x = Ops::load(a + i);
+        const vec y = b_step ? Ops::load(b + i) : b_scalar;
+        const vec q = Ops::load(p + i);
+        if (Ops::all_less(x, q) && Ops::all_less(y, q)) {
+            Ops::store(r + i, barrett_mul<Ops>(x, y, q, Ops::load(mu + i), Ops::load(log2p + i)));
+        } else {
+            modop_exact<Ops, true>(r + i, a + i, b + i * b_step, b_step, p + i, Ops::lanes);
+        }
+    }
+}
+
+// Contiguous modular negation over `count` elements (a multiple of Ops::lanes): p - a for
+// a in (0, p), folded to 0 for a = 0 by the conditional subtract; vectors with an operand
+// outside [0, p) get the residue of -a. `r` may alias `a`.
+template <typename Ops>
+void modneg_contiguous(typename Ops::word* r, const typename Ops::word* a, int64_t count,
+                       const typename Ops::word* p) {
+    using vec = typename Ops::vec;
+    using word = typename Ops::word;
+    using S = std::make_signed_t<word>;
+
+    for (int64_t i = 0; i < count; i += Ops::lanes) {
+        const vec x = Ops::load(a + i);
+        const vec q = Ops::load(p + i);
+        if (Ops::all_less(x, q)) {
+            Ops::store(r + i, Ops::csub(Ops::sub(q, x), q));
+        } else {
+            for (int64_t j = i; j < i + Ops::lanes; ++j) {
+                const T_DP<S> v = -static_cast<T_DP<S>>(static_cast<S>(a[j])) % static_cast<S>(p[j]);
+                r[j] = static_cast<word>(static_cast<S>(v < 0 ? v + static_cast<S>(p[j]) : v));
+            }
+        }
+    }
+}
+
+// modmuladd's reference semantics, (a * b + c) % p in signed double width.
+template <typename Ops>
+void modmuladd_exact(typename Ops::word* r, const typename Ops::word* a,
+                     const typename Ops::word* b, int64_t b_step, const typename Ops::word* c,
+                     const typename Ops::word* p, int64_t count) {
+    using word = typename Ops::word;
+    using S = std::make_signed_t<word>;
+    for (int64_t i = 0; i < count; ++i) {
+        const T_DP<S> v = static_cast<T_DP<S>>(static_cast<S>(a[i])) * static_cast<S>(b[i * b_step]) +
+                          static_cast<S>(c[i]);
+        r[i] = static_cast<word>(static_cast<S>(v % static_cast<S>(p[i])));
+    }
+}
+
+// Contiguous fused a * b + c: like modmul_contiguous with a dense addend c, whose add is
+// folded into the Barrett result with one conditional subtract. `r` may alias a, b or c.
+template <typename Ops>
+void modmuladd_contiguous(typename Ops::word* r, const typename Ops::word* a,
+                          const typename Ops::word* b, int64_t b_step,
+                          const typename Ops::word* c, int64_t count,
+                          const typename Ops::word* p, const typename Ops::word* mu,
+                          const typename Ops::word* log2p) {
+    using vec = typename Ops::vec;
+    const vec b_scalar = Ops::set1(b[0]);
+
+    for (int64_t i = 0; i < count; i += Ops::lanes) {
+        const vec x = Ops::load(a + i);
+        const vec y = b_step ? Ops::load(b + i) : b_scalar;
+        const vec z = Ops::load(c + i);
+        const vec q = Ops::load(p + i);
+        if (Ops::all_less(x, q) && Ops::all_less(y, q) && Ops::all_less(z, q)) {
+            const vec prod = barrett_mul<Ops>(x, y, q, Ops::load(mu + i), Ops::load(log2p + i));
+            Ops::store(r + i, Ops::csub(Ops::add(prod, z), q));
+        } else {
+            modmuladd_exact<Ops>(r + i, a + i, b + i * b_step, b_step, c + i, p + i, Ops::lanes);
+        }
+    }
+}
+
+// Lane-wise montgomery_mul_word (mod_arith.h): a * b * R^-1 mod p for a, b < p, with
+// p_inv = p^-1 mod R. The high-word difference lies in (-p, p); adding p to the lanes
+// that wrapped is a conditional subtract of -p.
+template <typename Ops>
+inline typename Ops::vec montgomery_mul(typename Ops::vec a, typename Ops::vec b,
+                                        typename Ops::vec p, typename Ops::vec p_inv) {
+    using vec = typename Ops::vec;
+    const vec m = Ops::mullo(Ops::mullo(a, b), p_inv);
+    const vec r = Ops::sub(Ops::mulhi(a, b), Ops::mulhi(m, p));
+    return Ops::csub(r, Ops::sub(Ops::set1(0), p));
+}
+
+// The Montgomery product of each element's residues, for vectors with an operand outside
+// [0, p).
+template <typename Ops>
+void montmul_exact(typename Ops::word* r, const typename Ops::word* a,
+                   const typename Ops::word* b, int64_t b_step, const typename Ops::word* p,
+                   const typename Ops::word* p_inv, int64_t count) {
+    using word = typename Ops::word;
+    using S = std::make_signed_t<word>;
+    const auto residue = [](word x, word q) {
+        const S v = static_cast<S>(x) % static_cast<S>(q);
+        return static_cast<word>(v < 0 ? v + static_cast<S>(q) : v);
+    };
+    for (int64_t i = 0; i < count; ++i) {
+        r[i] = montgomery_mul_word<S>(residue(a[i], p[i]), residue(b[i * b_step], p[i]), p[i], p_inv[i]);
+    }
+}
+
+// Contiguous Montgomery product over `count` elements (a multiple of Ops::lanes), laid out
+// like modmul_contiguous with p_inv[i] in place of the Barrett constants. `r` may alias
+// `a` or `b`.
+template <typename Ops>
+void montmul_contiguous(typename Ops::word* r, const typename Ops::word* a,
+                        const typename Ops::word* b, int64_t b_step, int64_t count,
+                        const typename Ops::word* p, const typename Ops::word* p_inv) {
+    using vec = typename Ops::vec;
+    const vec b_scalar = Ops::set1(b[0]);
+
+    for (int64_t i = 0; i < count; i += Ops::lanes) {
+        const vec x = Ops::load(a + i);
+        const vec y = b_step ? Ops::load(b + i) : b_scalar;
+        const vec q = Ops::load(p + i);
+        if (Ops::all_less(x, q) && Ops::all_less(y, q)) {
+            Ops::store(r + i, montgomery_mul<Ops>(x, y, q, Ops::load(p_inv + i)));
+        } else {
+            montmul_exact<Ops>(r + i, a + i, b + i * b_step, b_step, p + i, p_inv + i, Ops::lanes);
+        }
+    }
+}
+
+} // namespace
+} // namespace simd
+} // namespace lattica_hw_api
+
+// Defines the simd_kernels.h entry points of one instruction set for one word type.
+#define LATTICA_DEFINE_NTT_COLUMN_KERNELS(ISA, OPS)                                         \
+    void ntt_column_stages_##ISA(OPS::word* x, int64_t row_stride, int64_t n, int64_t root, \
+                                 int64_t lanes, const OPS::word* w,                         \
+                                 const OPS::word* w_shoup, int64_t tw_stride,               \
+                                 const OPS::word* mod) {                                    \
+        ntt_column_stages<OPS>(x, row_stride, n, root, lanes, w, w_shoup, tw_stride, mod);  \
+    }                                                                                       \
+    void ntt_column_reduce_##ISA(OPS::word* x, int64_t row_stride, int64_t m,               \
+                                 int64_t lanes, const OPS::word* mod) {                     \
+        ntt_column_reduce<OPS>(x, row_stride, m, lanes, mod);                               \
+    }                                                                                       \
+    void intt_column_stages_##ISA(OPS::word* x, int64_t row_stride, int64_t n, int64_t root,\
+                                  int64_t lanes, const OPS::word* w,                        \
+                                  const OPS::word* w_shoup, int64_t tw_stride,              \
+                                  const OPS::word* mod, const OPS::word* fold) {            \
+        intt_column_stages<OPS>(x, row_stride, n, root, lanes, w, w_shoup, tw_stride, mod,  \
+                                fold);                                                      \
+    }
+
+// Defines the simd_kernels.h contiguous modop entry points of one instruction set for one
+// word type.
+#define LATTICA_DEFINE_MODOP_CONTIGUOUS_KERNELS(ISA, OPS)                                   \
+    void modsum_contiguous_##ISA(OPS::word* r, const OPS::word* a, const OPS::word* b,      \
+                                 int64_t b_step, int64_t count, const OPS::word* p) {       \
+        modsum_contiguous<OPS>(r, a, b, b_step, count, p);                                  \
+    }                                                                                       \
+    void modneg_contiguous_##ISA(OPS::word* r, const OPS::word* a, int64_t count,           \
+                                 const OPS::word* p) {                                      \
+        modneg_contiguous<OPS>(r, a, count, p);                                             \
+    }                                                                                       \
+    void modmul_contiguous_##ISA(OPS::word* r, const OPS::word* a, const OPS::word* b,      \
+                                 int64_t b_step, int64_t count, const OPS::word* p,         \
+                                 const OPS::word* mu, const OPS::word* log2p) {             \
+        modmul_contiguous<OPS>(r, a, b, b_step, count, p, mu, log2p);                       \
+    }                                                                                       \
+    void modmuladd_contiguous_##ISA(OPS::word* r, const OPS::word* a, const OPS::word* b,   \
+                                    int64_t b_step, const OPS::word* c, int64_t count,      \
+                                    const OPS::word* p, const OPS::word* mu,                \
+                                    const OPS::word* log2p) {                               \
+        modmuladd_contiguous<OPS>(r, a, b, b_step, c, count, p, mu, log2p);                 \
+    }                                                                                       \
+    void montmul_contiguous_##ISA(OPS::word* r, const OPS::word* a, const OPS::word* b,     \
+                                  int64_t b_step, int64_t count, const OPS::word* p,        \
+                                  const OPS::word* p_inv) {                                 \
+        montmul_contiguous<OPS>(r, a, b, b_step, count, p, p_inv);                          \
+    }
+
+#endif // SIMD_OPS_H
@@ -0,0 +1,153 @@
+#ifndef STRIDED_LOOP_H
+#define STRIDED_LOOP_H
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+#include <omp.h>
+
+namespace lattica_hw_api {
+
+/**
+ * @brief Dims and element strides of one operand of a StridedLoop.
+ *
+ * The dims are aligned with the trailing dimensions of the iteration shape, PyTorch
+ * style: missing leading dims and dims of size 1 are broadcast (stride 0). An operand
+ * with no dims at all is a scalar, read at offset 0 for every element.
+ */
+struct StridedOperand {
+    const int64_t* dims = nullptr;
+    const int64_t* strides = nullptr;
+    int64_t ndim = 0;
+
+    StridedOperand() = default;
+    StridedOperand(const std::vector<int64_t>& dims, const std::vector<int64_t>& strides)
+        : dims(dims.data()), strides(strides.data()), ndim(static_cast<int64_t>(dims.size())) {}
+};
+
+/**
+ * @brief Elementwise iteration over N strided operands without per-element index math.
+ *
+ * The constructor resolves every operand's broadcast strides against the iteration
+ * shape, drops size-1 dims and merges adjacent dims that are contiguous for all
+ * operands, so a fully contiguous problem becomes one dimension. run() then hands the
+ * body runs along the innermost dim:
+ *
+ *     body(pos, offset, stride, count)
+ *
+ * where pos is the row-major index of the run's first element, offset[i] its element
+ * offset in operand i and stride[i] the element stride of operand i along the run.
+ * Offsets are advanced incrementally (odometer style) between runs; nothing is
+ * allocated per element or per run.
+ *
+ * An operand dim must be 1 or equal to the iteration dim; an operand dim smaller than
+ * the iteration dim throws std::out_of_range (as at() would), a larger one is read
+ * only up to the iteration dim.
+ */
+template <size_t N>
+class StridedLoop {
+public:
+    StridedLoop(const std::vector<int64_t>& shape, const std::array<StridedOperand, N>& operands) {
+        const int64_t ndim = static_cast<int64_t>(shape.size());
+        numel_ = 1;
+        for (int64_t d = 0; d < ndim; ++d) numel_ *= shape[d];
+
+        for (int64_t d = 0; d < ndim; ++d) {
+            if (shape[d] == 1) continue;
+
+            std::array<int64_t, N> stride{};
+            for (size_t i = 0; i < N; ++i) {
+                const StridedOperand& op = operands[i];
+                const int64_t od = d - (ndim - op.ndim);
+                if (od < 0 || op.dims[od] == 1) continue;
+                if (op.dims[od] < shape[d])
+                    throw std::out_of_range("Index out of bounds.");
+                stride[i] = op.strides[od];
+            }
+
+            if (!sizes_.empty() && mergeable(strides_.back(), stride, shape[d])) {
+                sizes_.back() *= shape[d];
+                strides_.back() = stride;
+            } else {
+                sizes_.push_back(shape[d]);
+                strides_.push_back(stride);
+            }
+        }
+        if (sizes_.empty()) {
+            sizes_.push_back(1);
+            strides_.push_back(std::array<int64_t, N>{});
+        }
+    }
+
+    int64_t numel() const { return numel_; }
+    int64_t ndim() const { return static_cast<int64_t>(sizes_.size()); }
+
+    // Innermost run length and per-operand strides after coalescing.
+    int64_t inner_size() const { return sizes_.back(); }
+    const std::array<int64_t, N>& inner_strides() const { return strides_.back(); }
+
+    // Walks elements [begin, end) in row-major order of the iteration shape.
+    template <typename Body>
+    void run(int64_t begin, int64_t end, const Body& body) const {
+        if (begin >= end) return;
+        const int64_t nd = ndim();
+        const int64_t inner = nd - 1;
+
+        std::vector<int64_t> idx(nd);
+        std::array<int64_t, N> offset{};
+        int64_t rem = begin;
+        for (int64_t d = inner; d >= 0; --d) {
+            idx[d] = rem % sizes_[d];
+            rem /= sizes_[d];
+            for (size_t i = 0; i < N; ++i) offset[i] += idx[d] * strides_[d][i];
+        }
+
+        for (int64_t pos = begin; pos < end;) {
+            const int64_t count = std::min(sizes_[inner] - idx[inner], end - pos);
+            body(pos, offset, strides_[inner], count);
+            pos += count;
+
+            idx[inner] += count;
+            for (size_t i = 0; i < N; ++i) offset[i] += count * strides_[inner][i];
+            for (int64_t d = inner; d > 0 && idx[d] == sizes_[d]; --d) {
+                idx[d] = 0;
+                ++idx[d - 1];
+                for (size_t i = 0; i < N; ++i)
+                    offset[i] += strides_[d - 1][i] - sizes_[d] * strides_[d][i];
+            }
+        }
+    }
+
+    // run() over all elements, split into one contiguous range per OpenMP thread once
+    // there are at least `grain` elements.
+    template <typename Body>
+    void parallel_run(const Body& body, int64_t grain = 32768) const {
+        #pragma omp parallel if (numel_ >= grain)
+        {
+            const int64_t threads = omp_get_num_threads();
+            const int64_t thread = omp_get_thread_num();
+            run(numel_ * thread / threads, numel_ * (thread + 1) / threads, body);
+        }
+    }
+
+private:
+    // Outer dim (strides `outer`) followed by an inner dim of `inner_size` elements with
+    // strides `inner` form a single dim when every operand steps evenly across them.
+    static bool mergeable(const std::array<int64_t, N>& outer, const std::array<int64_t, N>& inner,
+                          int64_t inner_size) {
+        for (size_t i = 0; i < N; ++i) {
+            if (outer[i] != inner[i] * inner_size) return false;
+        }
+        return true;
+    }
+
+    int64_t numel_ = 1;
+    std::vector<int64_t> sizes_;
+    std::vector<std::array<int64_t, N>> strides_;
+};
+
+} // namespace lattica_hw_api
+
+#endif // STRIDED_LOOP_H
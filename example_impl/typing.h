@@ -1,3 +1,6 @@
+#ifndef TYPING_H
+#define TYPING_H
+
 #include <cstdint>
 #include <type_traits>
 
@@ -17,4 +20,6 @@ struct TypeMapper<int64_t> {
 
 // Helper alias for convenience
 template <typename T>
-using T_DP = typename TypeMapper<T>::type;
\ No newline at end of file
+using T_DP = typename TypeMapper<T>::type;
+
+#endif // TYPING_H
@@ -14,9 +14,27 @@
  * - Tensor `p` must be a 1D tensor of shape `[k]`.
  * - Tensor `result` must have the same shape as `a` with the `axis` dimension removed.
  * - The reduction is performed along the given `axis`, and results are reduced modulo `p`.
+ *   Terms in [0, p) are summed exactly in double width and reduced once per output; an
+ *   output with a term outside [0, p) gets the term-by-term `sum = (sum + x) % p` result.
+ * - Few outputs over a long axis are parallelized over the axis instead of the outputs.
  *
  * Example:
  * - If `a` has shape [m, s, k] and `axis = 1`, `result` must have shape [m, k].
+ *
+ * modmul_axis_sum fuses an elementwise product into the reduction (a modular inner
+ * product, as in key switching: decomposed digits times key tensors, summed over the
+ * digit axis):
+ * - `a` and `b` broadcast against each other (PyTorch rules) to a shape `[..., k]`.
+ * - `axis` indexes that broadcast shape; `result` has the broadcast shape with `axis`
+ *   removed.
+ * - result = (Σ_axis a * b) mod p, in [0, p). Products are accumulated exactly in
+ *   double-width words and reduced once per output; operands outside [0, p) are
+ *   reduced into [0, p) first. Every modulus must be positive.
+ *
+ * Montgomery form (modop.h): axis_modsum keeps the form of `a`. modmul_axis_sum returns
+ * a Montgomery-form result when either operand is in that form (reducing the extra
+ * factor R once per output when both are); the moduli must then be odd and below
+ * 2^30 (int32) / 2^62 (int64).
  */
 
 namespace lattica_hw_api {
@@ -29,6 +47,15 @@ namespace lattica_hw_api {
         int64_t axis                                      // axis to reduce
     );
 
+    template <typename T>
+    void modmul_axis_sum(
+        const std::shared_ptr<DeviceTensor<T>>& a,        // input tensor, broadcastable with b
+        const std::shared_ptr<DeviceTensor<T>>& b,        // input tensor, broadcastable with a
+        const std::shared_ptr<DeviceTensor<T>>& p,        // modulus [k]
+        std::shared_ptr<DeviceTensor<T>>& result,         // broadcast shape with axis removed
+        int64_t axis                                      // axis of the broadcast shape to reduce
+    );
+
 }
 
 #endif // AXIS_MODSUM_H
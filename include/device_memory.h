@@ -18,7 +18,11 @@ struct DeviceTensor {
 namespace lattica_hw_api {
 
 /**
- * @brief Allocate a new device tensor on hardware.
+ * @brief Allocate a new zero-filled device tensor on hardware.
+ *
+ * The buffer comes from the caching pool of memory_pool.h and goes back to it when the
+ * last reference to the tensor is dropped. While a memory plan is active (memory_plan.h)
+ * it is the plan's next buffer instead.
  * @param dims Shape of the tensor.
  */
 template <typename T>
@@ -26,17 +30,37 @@ std::shared_ptr<DeviceTensor<T>> allocate_on_hardware(const std::vector<int64_t>
 
 /**
  * @brief Upload a PyTorch tensor to device memory.
- * @param tensor A contiguous torch::Tensor of type T.
+ * @param tensor A torch::Tensor of type T; its strides are kept.
+ * @param zero_copy Share the tensor's storage instead of copying it. The DeviceTensor
+ *        keeps the storage alive, and writes through either one are seen by the other.
+ *        Requires a CPU tensor.
  */
 template <typename T>
-std::shared_ptr<DeviceTensor<T>> host_to_device(const torch::Tensor& tensor);
+std::shared_ptr<DeviceTensor<T>> host_to_device(const torch::Tensor& tensor, bool zero_copy = false);
 
 /**
  * @brief Download a device tensor back into a torch::Tensor.
  * @param memory A shared pointer to the device tensor.
+ * @param view Return a tensor over the device buffer instead of a copy. It keeps the
+ *        buffer alive and sees later writes to it.
  */
 template <typename T>
-torch::Tensor device_to_host(const std::shared_ptr<DeviceTensor<T>>& memory);
+torch::Tensor device_to_host(const std::shared_ptr<DeviceTensor<T>>& memory, bool view = false);
+
+/**
+ * @brief Whether a device tensor holds its values in Montgomery form, x * R mod p (see
+ *        modop.h).
+ */
+template <typename T>
+bool is_montgomery(const std::shared_ptr<DeviceTensor<T>>& memory);
+
+/**
+ * @brief The NUMA node holding most of a device tensor's pages (see memory_pool.h).
+ * @return The node, or -1 when it is unknown: no page has been touched yet, or the
+ *         library was built without libnuma.
+ */
+template <typename T>
+int numa_node_of(const std::shared_ptr<DeviceTensor<T>>& memory);
 
 } // namespace lattica_hw_api
 
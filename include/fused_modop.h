@@ -0,0 +1,75 @@
+#ifndef FUSED_MODOP_H
+#define FUSED_MODOP_H
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+/**
+ * @file fused_modop.h
+ * @brief Lazy elementwise modular expressions, evaluated in one pass over memory.
+ *
+ * A FusedModop records a small DAG of elementwise ops over DeviceTensors and scalars;
+ * evaluate() computes one node of it into `result` without materializing the nodes in
+ * between. A chain such as modmul -> modsum -> mod -> modmul over one shape then reads
+ * each input once and writes the result once, instead of round-tripping every step
+ * through a DeviceTensor.
+ *
+ * Building:
+ * - input(tensor) and scalar(value) add leaves; modsum, modmul and mod add ops over
+ *   earlier nodes. Each call returns the new node's id (its index), so the nodes are in
+ *   topological order by construction.
+ * - modsum(a, b, p) and modmul(a, b, p) compute (a + b) % p and (a * b) % p as in
+ *   modop.h. p must be a leaf: a scalar, or a `[k]` tensor along the last axis of the
+ *   result (k = 1 or the result's last dim).
+ * - mod(a, b) is the remainder a % b, as in mod_tt.
+ *
+ * Evaluation:
+ * - Tensor leaves broadcast against `result` (PyTorch rules) and may be non-contiguous;
+ *   at most max_fused_inputs distinct tensors are read. `result` may be one of the
+ *   inputs if it has the same layout (an in-place update).
+ * - The result is walked in tiles of up to 1024 elements. Each op runs over a whole tile
+ *   with modop's kernels (AVX2 / AVX-512 when available, Barrett constants from the
+ *   shared modulus cache), holding intermediates in per-thread tile buffers.
+ * - Only nodes that the evaluated node depends on are computed.
+ * - Inputs are read when evaluate() runs, so one graph can be evaluated repeatedly while
+ *   its input tensors are rewritten. Montgomery-form tensors are rejected.
+ */
+
+namespace lattica_hw_api {
+
+    constexpr int64_t max_fused_inputs = 7;
+
+    template <typename T>
+    class FusedModop {
+    public:
+        using Node = int64_t;
+
+        enum class Op { input, scalar, modsum, modmul, mod };
+
+        struct Step {
+            Op op;
+            Node a = -1, b = -1, p = -1;                 // operands of op nodes
+            T value = 0;                                 // scalar leaf
+            std::shared_ptr<DeviceTensor<T>> tensor;     // input leaf
+        };
+
+        Node input(const std::shared_ptr<DeviceTensor<T>>& tensor);
+        Node scalar(T value);
+        Node modsum(Node a, Node b, Node p);
+        Node modmul(Node a, Node b, Node p);
+        Node mod(Node a, Node b);
+
+        void evaluate(Node node, std::shared_ptr<DeviceTensor<T>>& result) const;
+
+        const std::vector<Step>& steps() const { return steps_; }
+
+    private:
+        Node add_op(Op op, Node a, Node b, Node p);
+
+        std::vector<Step> steps_;
+    };
+
+}
+
+#endif // FUSED_MODOP_H
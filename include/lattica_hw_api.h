@@ -5,9 +5,12 @@
 #include "device_memory.h"  // Device data format
 #include "memory_virtual_ops.h"     // Memory operations
 #include "contiguous.h"      // Contiguous memory
+#include "memory_pool.h"     // Buffer caching and statistics
+#include "memory_plan.h"     // Static buffer placement for transcripts
 
 // ============= Modular arithmetic ============== //
 #include "modop.h"
+#include "fused_modop.h"   // Fused elementwise expressions
 #include "axis_modsum.h"
 
 // ============ Special-purpose ops ============== //
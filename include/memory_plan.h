@@ -0,0 +1,87 @@
+#ifndef MEMORY_PLAN_H
+#define MEMORY_PLAN_H
+
+#include <cstdint>
+#include <vector>
+
+/**
+ * @file memory_plan.h
+ * @brief Static placement of a transcript's intermediate buffers in one arena.
+ *
+ * A transcript is a straight-line program whose FREE_DEVICE_TENSOR markers give every
+ * buffer's lifetime before anything runs. A MemoryPlan takes those lifetimes, assigns
+ * each buffer an offset in a single arena so that buffers alive at the same step never
+ * overlap, and reports the arena size -- the peak footprint -- up front.
+ *
+ * Planning:
+ * - Buffer i is alive from step `first` to step `last`, both inclusive; steps are any
+ *   increasing numbering, such as transcript positions.
+ * - Sizes are rounded up to memory_pool_alignment, so every buffer is 64-byte aligned.
+ * - Offsets come from replaying the lifetimes in step order against a best-fit
+ *   allocator over the arena: each buffer takes the smallest free gap that holds it
+ *   (freed neighbours are coalesced) and grows the arena only when none does.
+ *   max_live_bytes(), the largest total of buffers alive at one step, is a lower bound
+ *   for arena_bytes(); the gap between them is the fragmentation of the plan.
+ *
+ * Execution:
+ * - begin_memory_plan() allocates the arena from the memory pool. While the plan is
+ *   active, the n-th allocate_on_hardware call returns buffer n of the plan: a pointer
+ *   bump into the arena, zero-filled as usual, with no allocator traffic. The caller
+ *   must issue the calls in the order the buffers were listed.
+ * - A call asking for more bytes than its planned buffer throws std::runtime_error;
+ *   calls beyond the last planned buffer fall back to the pool.
+ * - end_memory_plan() deactivates the plan. Tensors handed out keep the arena alive, so
+ *   it returns to the pool when the last of them is released.
+ * - Releasing a tensor early is harmless; keeping one past its planned `last` step is
+ *   not, since a later buffer may share its bytes.
+ */
+
+namespace lattica_hw_api {
+
+    struct BufferLifetime {
+        int64_t bytes = 0;
+        int64_t first = 0;   // step that allocates the buffer
+        int64_t last = 0;    // last step that may use it
+    };
+
+    class MemoryPlan {
+    public:
+        /**
+         * @brief Plans `buffers` in the order given. Throws std::invalid_argument for
+         *        negative sizes or steps, or `last` before `first`.
+         */
+        explicit MemoryPlan(const std::vector<BufferLifetime>& buffers);
+
+        int64_t num_buffers() const { return static_cast<int64_t>(buffers_.size()); }
+        const BufferLifetime& buffer(int64_t i) const { return buffers_.at(i); }
+        int64_t offset(int64_t i) const { return offsets_.at(i); }
+
+        int64_t arena_bytes() const { return arena_bytes_; }
+        int64_t max_live_bytes() const { return max_live_bytes_; }
+
+    private:
+        std::vector<BufferLifetime> buffers_;
+        std::vector<int64_t> offsets_;
+        int64_t arena_bytes_ = 0;
+        int64_t max_live_bytes_ = 0;
+    };
+
+    /**
+     * @brief Allocates the arena of `plan` and routes the following allocate_on_hardware
+     *        calls into it. Replaces a plan that is still active.
+     */
+    void begin_memory_plan(const MemoryPlan& plan);
+
+    /**
+     * @brief Deactivates the current plan, if any; allocate_on_hardware uses the pool again.
+     */
+    void end_memory_plan();
+
+    /**
+     * @brief Number of planned buffers handed out so far, or -1 when no plan is active.
+     */
+    int64_t memory_plan_position();
+
+}
+
+#endif // MEMORY_PLAN_H
@@ -0,0 +1,123 @@
+#ifndef MEMORY_POOL_H
+#define MEMORY_POOL_H
+
+#include <cstdint>
+
+/**
+ * @file memory_pool.h
+ * @brief Statistics and controls of the caching allocator behind DeviceTensor buffers.
+ *
+ * Every DeviceTensor buffer (allocate_on_hardware, host_to_device) comes from one
+ * process-wide pool. Requests are rounded up to a size class: a multiple of a quarter of
+ * the next lower power of two, at least 64 bytes, so at most 25% is wasted. When the last
+ * reference to a buffer is dropped it goes onto the free list of its class, and a later
+ * request of the same class reuses it without calling the system allocator.
+ *
+ * Page policy:
+ * - Every buffer is aligned to memory_pool_alignment (64 bytes: a cache line and an
+ *   AVX-512 vector).
+ * - Buffers of at least the huge-page threshold (default 2 MiB) are mapped on their own,
+ *   rounded up to whole 2 MiB pages, so large RNS tensors take fewer TLB entries:
+ *   - transparent (default): a 2 MiB-aligned anonymous mapping with
+ *     madvise(MADV_HUGEPAGE), which the kernel backs with huge pages when it can.
+ *   - explicit_pages: MAP_HUGETLB from the reserved pool (vm.nr_hugepages), falling back
+ *     to transparent when no reserved pages are left.
+ *   - off: the mapping uses standard pages.
+ * - The mode can be set with set_memory_pool_huge_pages() or the LATTICA_HUGE_PAGES
+ *   environment variable ("off", "transparent" or "explicit"), read once at startup.
+ *   It applies to buffers allocated afterwards; a free list may still hand out a cached
+ *   buffer of the same size class that was allocated under another mode.
+ * - DeviceTensor::print_metadata() reports the alignment and backing of its buffer.
+ * - Huge pages are only used on Linux.
+ *
+ * NUMA placement:
+ * - first_touch (default): zero-filled buffers are cleared, and host_to_device copies
+ *   are written, by all OpenMP threads, each taking the contiguous share of the buffer
+ *   that the kernels' static partitioning assigns it. A page then lands on the node of
+ *   the thread that later computes on it, instead of all pages landing on the node of
+ *   one allocating thread.
+ * - interleave: the pages of each mapped buffer are spread round-robin over all nodes.
+ * - bind: the pages of each mapped buffer are placed on one node.
+ * - interleave and bind act on mapped buffers (those of at least the huge-page
+ *   threshold) and need libnuma at build time (LATTICA_HAVE_LIBNUMA, set by CMake when
+ *   it finds the library); smaller buffers follow first touch.
+ * - Like the page mode, the policy applies to buffers allocated afterwards. A reused
+ *   buffer keeps the placement of its first allocation.
+ * - numa_node_of() (device_memory.h) reports the node a tensor's pages are on.
+ *
+ * Implementation Notes:
+ * - Free lists hold at most get_memory_pool_cache_limit() bytes (default 1 GiB); a
+ *   released buffer that would exceed it is returned to the system.
+ * - allocate_on_hardware still returns zero-filled memory: fresh mappings are zero
+ *   already (and are only written again under first_touch), other buffers are cleared.
+ * - The pool is thread-safe.
+ */
+
+namespace lattica_hw_api {
+
+    constexpr int64_t memory_pool_alignment = 64;
+
+    enum class HugePageMode { off, transparent, explicit_pages };
+
+    enum class NumaPolicy { first_touch, interleave, bind };
+
+    struct MemoryPoolStats {
+        int64_t hits = 0;              // allocations served from a free list
+        int64_t misses = 0;            // allocations passed to the system allocator
+        int64_t cached_bytes = 0;      // bytes held in free lists
+        int64_t live_bytes = 0;        // bytes in buffers still referenced
+        int64_t peak_live_bytes = 0;   // maximum of live_bytes since the last reset
+    };
+
+    MemoryPoolStats get_memory_pool_stats();
+
+    /**
+     * @brief Zeroes the hit / miss counters and restarts peak_live_bytes from live_bytes.
+     */
+    void reset_memory_pool_stats();
+
+    /**
+     * @brief Returns every cached buffer to the system allocator.
+     */
+    void release_memory_pool_cache();
+
+    /**
+     * @brief Sets the most bytes the free lists may hold (0 disables caching) and trims
+     *        them to it. Throws std::invalid_argument for negative values.
+     */
+    void set_memory_pool_cache_limit(int64_t bytes);
+
+    int64_t get_memory_pool_cache_limit();
+
+    /**
+     * @brief Sets the huge-page mode and the smallest buffer (in bytes) it applies to.
+     *        Throws std::invalid_argument for a negative threshold.
+     */
+    void set_memory_pool_huge_pages(HugePageMode mode, int64_t threshold_bytes = int64_t(1) << 21);
+
+    HugePageMode get_memory_pool_huge_page_mode();
+
+    int64_t get_memory_pool_huge_page_threshold();
+
+    /**
+     * @brief Number of NUMA nodes; 1 without libnuma.
+     */
+    int numa_node_count();
+
+    /**
+     * @brief Sets the NUMA placement of new buffers; `node` is the target of bind and is
+     *        ignored otherwise. Throws std::runtime_error for interleave / bind without
+     *        libnuma, and std::invalid_argument for a bind node out of range.
+     */
+    void set_memory_pool_numa_policy(NumaPolicy policy, int node = -1);
+
+    NumaPolicy get_memory_pool_numa_policy();
+
+    /**
+     * @brief The bind target, or -1 under the other policies.
+     */
+    int get_memory_pool_numa_node();
+
+}
+
+#endif // MEMORY_POOL_H
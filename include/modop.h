@@ -13,6 +13,8 @@
  * Operations:
  * - Multiplication: result = (a * b) % p
  * - Addition:       result = (a + b) % p
+ * - Multiply-add:   result = (a * b + c) % p
+ * - Negation:       result = (-a) % p, in [0, p) for any a
  * - Remainder:      result = a % b
  *
  * Common requirements:
@@ -23,7 +25,7 @@
  * - All inputs must be of the same element type `T` (except scalar remainders use int64_t).
  * - Non-contiguous tensors are supported using internal stride-aware indexing.
  *
- * Broadcasting semantics follow PyTorch's rules (only in multiplication and addition):
+ * Broadcasting semantics follow PyTorch's rules (not in the remainder ops):
  * - Dimensions are compared from the trailing dimensions backward.
  * - A dimension of size 1 can be expanded to match the other tensor's size.
  * - Leading dimensions can be added implicitly.
@@ -34,10 +36,49 @@
  * - tct: first and last inputs are tensors, middle is scalar
  * - tcc: first input is tensor, next two are scalars
  *
+ * Multiply-add takes the variants of multiplication (the letters name a, b and p); the
+ * addend `c` is always a tensor broadcastable to the result. It replaces a modmul into a
+ * temporary followed by a modsum: one pass over memory and one reduction per element.
+ *
+ * Negation variants (the letters name a and p):
+ * - tt: p is a tensor
+ * - tc: p is a scalar
+ *
  * Additional remainder variants (modulus):
  * - tt: both a and b are tensors
  * - tc: a is tensor, b is scalar
  * - ct: a is scalar, b is tensor
+ *
+ * Implementation Notes:
+ * - When `a`, `b` (unless scalar) and `result` are contiguous with the same shape and
+ *   `p` is a scalar or a `[k]` tensor along the last axis, mul/add run over the flat
+ *   buffers: AVX2 / AVX-512 kernels (picked at runtime, LATTICA_SIMD caps the level)
+ *   or a scalar loop, using add + conditional subtract, p - a and Barrett multiplication
+ *   (for 2 <= p < 2^30 (int32) / 2^62 (int64); other moduli take the generic path).
+ * - Operands outside [0, p) give the same result as the generic path's signed `%`
+ *   (for multiply-add, the `%` of a * b + c in double width).
+ * - Everything else goes through stride-aware iteration. With a scalar or 1-D `p` it
+ *   uses the same add / Barrett reductions, and runs that are dense along the last
+ *   axis still take the vector kernels.
+ * - The Barrett constants are derived once per distinct set of moduli and kept in a
+ *   small cache, matched on the values of `p` (so rewriting a `p` buffer in place is
+ *   safe).
+ * - Moduli listed in the compile-time registry (example_impl/modulus_registry.h) have
+ *   mul/add kernels specialized on p, used when no vector instruction set is available.
+ *
+ * Montgomery form:
+ * - to_montgomery maps a to a * R mod p (R = 2^32 for int32, 2^64 for int64) and flags the
+ *   result as Montgomery (see is_montgomery in device_memory.h); from_montgomery maps it
+ *   back. Both take a `[k]` (or `[1]`) tensor
+ *   p of odd moduli below 2^30 (int32) / 2^62 (int64) along the last axis.
+ * - modmul of two Montgomery tensors multiplies with Montgomery reduction (REDC) and keeps
+ *   the result in Montgomery form, so a chain of products converts once at each end. A
+ *   Montgomery tensor times a plain tensor or scalar is also in Montgomery form.
+ * - modsum needs both tensors in the same form; a plain scalar added to a Montgomery
+ *   tensor is converted first. modmuladd accepts one Montgomery factor with a Montgomery
+ *   addend. Negation keeps the form. The remainder ops reject Montgomery input.
+ * - Every operand of a Montgomery-form op (including a plain factor, addend or the input
+ *   of to_montgomery) is taken as its residue, so results are in [0, p) for any input.
  */
 
 namespace lattica_hw_api {
@@ -110,6 +151,76 @@ namespace lattica_hw_api {
         std::shared_ptr<DeviceTensor<T>>& result
     );
 
+    // ---------- Fused Modular Multiply-Add Variants ----------
+
+    template <typename T>
+    void modmuladd_ttt(
+        const std::shared_ptr<DeviceTensor<T>>& a,
+        const std::shared_ptr<DeviceTensor<T>>& b,
+        const std::shared_ptr<DeviceTensor<T>>& c,
+        const std::shared_ptr<DeviceTensor<T>>& p,
+        std::shared_ptr<DeviceTensor<T>>& result
+    );
+
+    template <typename T>
+    void modmuladd_ttc(
+        const std::shared_ptr<DeviceTensor<T>>& a,
+        const std::shared_ptr<DeviceTensor<T>>& b,
+        const std::shared_ptr<DeviceTensor<T>>& c,
+        T p_scalar,
+        std::shared_ptr<DeviceTensor<T>>& result
+    );
+
+    template <typename T>
+    void modmuladd_tct(
+        const std::shared_ptr<DeviceTensor<T>>& a,
+        T b_scalar,
+        const std::shared_ptr<DeviceTensor<T>>& c,
+        const std::shared_ptr<DeviceTensor<T>>& p,
+        std::shared_ptr<DeviceTensor<T>>& result
+    );
+
+    template <typename T>
+    void modmuladd_tcc(
+        const std::shared_ptr<DeviceTensor<T>>& a,
+        T b_scalar,
+        const std::shared_ptr<DeviceTensor<T>>& c,
+        T p_scalar,
+        std::shared_ptr<DeviceTensor<T>>& result
+    );
+
+    // ---------- Modular Negation Variants ----------
+
+    template <typename T>
+    void modneg_tt(
+        const std::shared_ptr<DeviceTensor<T>>& a,
+        const std::shared_ptr<DeviceTensor<T>>& p,
+        std::shared_ptr<DeviceTensor<T>>& result
+    );
+
+    template <typename T>
+    void modneg_tc(
+        const std::shared_ptr<DeviceTensor<T>>& a,
+        T p_scalar,
+        std::shared_ptr<DeviceTensor<T>>& result
+    );
+
+    // ---------- Montgomery Form ----------
+
+    template <typename T>
+    void to_montgomery(
+        const std::shared_ptr<DeviceTensor<T>>& a,
+        const std::shared_ptr<DeviceTensor<T>>& p,
+        std::shared_ptr<DeviceTensor<T>>& result
+    );
+
+    template <typename T>
+    void from_montgomery(
+        const std::shared_ptr<DeviceTensor<T>>& a,
+        const std::shared_ptr<DeviceTensor<T>>& p,
+        std::shared_ptr<DeviceTensor<T>>& result
+    );
+
     // ---------- Modular Remainder (Modulus) Variants ----------
 
     template <typename T>
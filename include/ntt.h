@@ -16,14 +16,47 @@
  *     - `r` is the right batch dimension.
  *     - `k` is the number of independent moduli.
  * - Modulus tensor `p` must have shape `[k]`.
- * - Permutation tensor `perm` must have shape `[m]`.
+ * - Permutation tensor `perm` must have shape `[m]` (may be nullptr with `skip_perm`).
  * - Twiddle factors `twiddles` must have shape `[k, m]`.
  * - Modular inverses of `m`, `m_inv`, must have shape `[k]`.
  * - Output tensor `result` must have shape `[l, m, r, k]`.
  *
- * Optional Barrett Reduction Parameters:
+ * Unused parameters (kept for API compatibility):
  * - `log2p_list` (shape `[k]`) – precomputed ⌊log₂(pᵢ)⌋ for each modulus pᵢ.
  * - `mu_list`    (shape `[k]`) – precomputed Barrett constant ⌊2²ⁿ / pᵢ⌋ for each modulus pᵢ.
+ * - Accepted for compatibility and not read: the transforms derive their own constants
+ *   from p and the twiddles (see Implementation Notes). Either may be nullptr.
+ *
+ * Permutation:
+ * - The butterflies leave the spectrum in bit-reversed order. ntt() writes
+ *   result[.., u, ..] = spectrum[perm[u]] and intt() reads its input through the
+ *   inverse mapping, both fused into the transform's own load/store pass.
+ * - With `skip_perm = true` ntt() returns the spectrum in butterfly (bit-reversed) order
+ *   and intt() expects its input in that order. Pointwise products do not care about
+ *   the order, so ntt(skip_perm) -> modmul -> intt(skip_perm) avoids the gather.
+ *
+ * Montgomery form:
+ * - The transforms are linear, so a tensor in Montgomery form (modop.h, to_montgomery)
+ *   is transformed as is and `result` keeps its `montgomery` flag: a chain of ntt,
+ *   modmul and intt stays in Montgomery form between to_montgomery and from_montgomery.
+ *
+ * Implementation Notes:
+ * - Twiddle multiplications use Shoup's precomputed-quotient method, with values kept
+ *   lazily in [0, 4p) between stages. This needs pᵢ < 2^30 (int32) / 2^62 (int64);
+ *   wider moduli fall back to double-width division.
+ * - Butterfly stages are merged pairwise into radix-4 sweeps (one radix-2 stage remains
+ *   when log₂(m) is odd), halving the passes over each line.
+ * - intt() folds the m⁻¹ scaling into its last stage (twiddles m⁻¹ and w₁·m⁻¹, formed
+ *   in double width), so it makes as many passes as ntt().
+ * - Shoup companions are derived once per (p, twiddles) pair and cached across calls;
+ *   an NttPlan skips the per-call reading, matching and validation of the tables.
+ * - With all moduli on the Shoup path, AVX2 / AVX-512 kernels (picked at runtime by
+ *   CPUID) transform adjacent (r, k) residues in vector lanes; lanes left over when
+ *   r·k is not a multiple of the width use the scalar kernels.
+ *   Set LATTICA_SIMD=scalar|avx2 to cap the level.
+ * - From m >= get_ntt_four_step_threshold() (default 2^13) each line is transformed in
+ *   cache-blocked four-step order: √m-point column transforms, then √m-point row
+ *   transforms. The result is bit-identical to the radix-2 order.
  */
 
 namespace lattica_hw_api {
@@ -36,7 +69,8 @@ namespace lattica_hw_api {
         const std::shared_ptr<DeviceTensor<T>>& twiddles,   // [k, m]
         const std::shared_ptr<DeviceTensor<T>>& log2p_list, // [k]
         const std::shared_ptr<DeviceTensor<T>>& mu_list,    // [k]
-        std::shared_ptr<DeviceTensor<T>>& result            // [l, m, r, k] (output)
+        std::shared_ptr<DeviceTensor<T>>& result,           // [l, m, r, k] (output)
+        bool skip_perm = false
     );
 
     template <typename T>
@@ -48,9 +82,73 @@ namespace lattica_hw_api {
         const std::shared_ptr<DeviceTensor<T>>& m_inv,         // [k]
         const std::shared_ptr<DeviceTensor<T>>& log2p_list,    // [k]
         const std::shared_ptr<DeviceTensor<T>>& mu_list,       // [k]
-        std::shared_ptr<DeviceTensor<T>>& result               // [l, m, r, k] (output)
+        std::shared_ptr<DeviceTensor<T>>& result,              // [l, m, r, k] (output)
+        bool skip_perm = false
+    );
+
+    /**
+     * @brief Precomputed transform state for one transform length and set of moduli.
+     *
+     * Built once from the same tensors ntt()/intt() take, which are validated, copied and
+     * not referenced afterwards: the twiddles are reduced and laid out in the order the
+     * kernels walk them (per stage, plus a residue-interleaved copy for the vector
+     * kernels) together with their Shoup companions, the permutation is decoded and m_inv
+     * is folded into the last inverse stage. The plan-based ntt()/intt() below then only
+     * check the shapes of `a` and `result`.
+     *
+     * Either direction may be left out: pass nullptr for `twiddles`, or for `inv_twiddles`
+     * and `m_inv`. `perm` may be nullptr if the plan is only used with skip_perm.
+     * log2p_list / mu_list are ignored as in ntt(). A plan is immutable, cheap to copy
+     * and safe to share between threads.
+     */
+    template <typename T>
+    class NttPlan {
+    public:
+        NttPlan(
+            const std::shared_ptr<DeviceTensor<T>>& p,                      // [k]
+            const std::shared_ptr<DeviceTensor<T>>& perm,                   // [m]
+            const std::shared_ptr<DeviceTensor<T>>& twiddles,               // [k, m]
+            const std::shared_ptr<DeviceTensor<T>>& inv_twiddles,           // [k, m]
+            const std::shared_ptr<DeviceTensor<T>>& m_inv,                  // [k]
+            const std::shared_ptr<DeviceTensor<T>>& log2p_list = nullptr,   // [k]
+            const std::shared_ptr<DeviceTensor<T>>& mu_list = nullptr       // [k]
+        );
+
+        int64_t m() const;
+        int64_t k() const;
+
+        // Implementation-defined tables, shared by copies of the plan.
+        struct Tables;
+        const Tables& tables() const { return *tables_; }
+
+    private:
+        std::shared_ptr<const Tables> tables_;
+    };
+
+    template <typename T>
+    void ntt(
+        const std::shared_ptr<DeviceTensor<T>>& a,          // [l, m, r, k]
+        const NttPlan<T>& plan,
+        std::shared_ptr<DeviceTensor<T>>& result,           // [l, m, r, k] (output)
+        bool skip_perm = false
+    );
+
+    template <typename T>
+    void intt(
+        const std::shared_ptr<DeviceTensor<T>>& a,          // [l, m, r, k]
+        const NttPlan<T>& plan,
+        std::shared_ptr<DeviceTensor<T>>& result,           // [l, m, r, k] (output)
+        bool skip_perm = false
     );
 
+    /**
+     * @brief Sets the transform length from which ntt()/intt() use the four-step order.
+     *        0 disables it. Throws std::invalid_argument for negative values.
+     */
+    void set_ntt_four_step_threshold(int64_t m);
+
+    int64_t get_ntt_four_step_threshold();
+
 }
 
 #endif // NTT_H
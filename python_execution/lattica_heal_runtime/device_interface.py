@@ -13,6 +13,12 @@ class DeviceDispatcher(ABC):
     def zeros(self, *args, **kwargs):
         return self.dispatcher.zeros(*args, **kwargs)
 
+    def begin_memory_plan(self, *args, **kwargs):
+        return self.dispatcher.begin_memory_plan(*args, **kwargs)
+
+    def end_memory_plan(self, *args, **kwargs):
+        return self.dispatcher.end_memory_plan(*args, **kwargs)
+
         # ================== I/O Ops ========================
 
     def device_to_host(self, *args, orig_python_path=None, **kwargs):
@@ -41,6 +47,15 @@ class DeviceDispatcher(ABC):
     def _modsum_tcc(self, *args, **kwargs):
         return self.dispatcher._modsum_tcc(*args, **kwargs)
 
+    def _modmuladd_ttt(self, *args, **kwargs):
+        return self.dispatcher._modmuladd_ttt(*args, **kwargs)
+    def _modmuladd_ttc(self, *args, **kwargs):
+        return self.dispatcher._modmuladd_ttc(*args, **kwargs)
+    def _modmuladd_tct(self, *args, **kwargs):
+        return self.dispatcher._modmuladd_tct(*args, **kwargs)
+    def _modmuladd_tcc(self, *args, **kwargs):
+        return self.dispatcher._modmuladd_tcc(*args, **kwargs)
+
     def _mod_tt(self, *args, **kwargs):
         return self.dispatcher._mod_tt(*args, **kwargs)
     def _mod_tc(self, *args, **kwargs):
@@ -67,6 +82,15 @@ class DeviceDispatcher(ABC):
     def modmul_axis_sum(self, *args, **kwargs):
         return self.dispatcher.modmul_axis_sum(*args, **kwargs)
 
+    def to_montgomery(self, *args, **kwargs):
+        return self.dispatcher.to_montgomery(*args, **kwargs)
+
+    def from_montgomery(self, *args, **kwargs):
+        return self.dispatcher.from_montgomery(*args, **kwargs)
+
+    def fused_modop(self, *args, **kwargs):
+        return self.dispatcher.fused_modop(*args, **kwargs)
+
     def take_along_axis(self, *args, **kwargs):
         return self.dispatcher.take_along_axis(*args, **kwargs)
 
@@ -91,11 +91,76 @@ _modsum = {
     }
 }
 
+_modmuladd = {
+    'ttt': {
+        DeviceTensor32: lhw.modmuladd_ttt_32,
+        DeviceTensor64: lhw.modmuladd_ttt_64,
+    },
+    'tcc': {
+        DeviceTensor32: lhw.modmuladd_tcc_32,
+        DeviceTensor64: lhw.modmuladd_tcc_64,
+    },
+    'tct': {
+        DeviceTensor32: lhw.modmuladd_tct_32,
+        DeviceTensor64: lhw.modmuladd_tct_64,
+    },
+    'ttc': {
+        DeviceTensor32: lhw.modmuladd_ttc_32,
+        DeviceTensor64: lhw.modmuladd_ttc_64,
+    }
+}
+
+_modneg = {
+    'tt': {
+        DeviceTensor32: lhw.modneg_tt_32,
+        DeviceTensor64: lhw.modneg_tt_64,
+    },
+    'tc': {
+        DeviceTensor32: lhw.modneg_tc_32,
+        DeviceTensor64: lhw.modneg_tc_64,
+    }
+}
+
+_mod = {
+    'tt': {
+        DeviceTensor32: lhw.mod_tt_32,
+        DeviceTensor64: lhw.mod_tt_64,
+    },
+    'tc': {
+        DeviceTensor32: lhw.mod_tc_32,
+        DeviceTensor64: lhw.mod_tc_64,
+    },
+    'ct': {
+        DeviceTensor32: lhw.mod_ct_32,
+        DeviceTensor64: lhw.mod_ct_64,
+    }
+}
+
 _axis_modsum = {
     DeviceTensor32: lhw.axis_modsum_32,
     DeviceTensor64: lhw.axis_modsum_64,
 }
 
+_modmul_axis_sum = {
+    DeviceTensor32: lhw.modmul_axis_sum_32,
+    DeviceTensor64: lhw.modmul_axis_sum_64,
+}
+
+_to_montgomery = {
+    DeviceTensor32: lhw.to_montgomery_32,
+    DeviceTensor64: lhw.to_montgomery_64,
+}
+
+_from_montgomery = {
+    DeviceTensor32: lhw.from_montgomery_32,
+    DeviceTensor64: lhw.from_montgomery_64,
+}
+
+_fused_modop = {
+    torch.int32: lhw.FusedModop32,
+    torch.int64: lhw.FusedModop64,
+}
+
 _ntt = {
     DeviceTensor32: lhw.ntt_32,
     DeviceTensor64: lhw.ntt_64,
@@ -111,19 +176,53 @@ def _dispatch(key, *args, impls):
 
 class PythonToCppDispatcher(ABC):
 
-    def host_to_device(self, tensor, dtype):
+    def __init__(self, zero_copy=False):
+        # zero_copy: host_to_device shares the torch storage instead of copying it (writes
+        # on the device side become visible in the host tensor), and device_to_host
+        # returns a view of the device buffer instead of a clone.
+        self.zero_copy = zero_copy
+
+    def host_to_device(self, tensor, dtype, zero_copy=None):
+        zero_copy = self.zero_copy if zero_copy is None else zero_copy
+        if zero_copy:
+            return _dispatch(dtype, torch.as_tensor(tensor, dtype=dtype), True, impls=_host_to_device)
         return _dispatch(dtype, torch.tensor(tensor, dtype=dtype), impls=_host_to_device)
 
-    def device_to_host(self, a):
-        return _dispatch(type(a), a, impls=_device_to_host)
+    def device_to_host(self, a, view=None):
+        view = self.zero_copy if view is None else view
+        return _dispatch(type(a), a, view, impls=_device_to_host)
 
     def empty(self, shape, dtype):
         return _dispatch(dtype, shape, impls=_allocate)
 
+    def begin_memory_plan(self, lifetimes):
+        # lifetimes: (bytes, first, last) per `empty` call to come, in call order
+        plan = lhw.MemoryPlan([lhw.BufferLifetime(*l) for l in lifetimes])
+        lhw.begin_memory_plan(plan)
+        return plan
+
+    def end_memory_plan(self):
+        lhw.end_memory_plan()
+
     def axis_modsum(self, a, axis, q_list, out):
         _dispatch(type(a), a, q_list, out, axis, impls=_axis_modsum)
         return out
 
+    def modmul_axis_sum(self, a, b, axis, q_list, out):
+        _dispatch(type(a), a, b, q_list, out, axis, impls=_modmul_axis_sum)
+        return out
+
+    def to_montgomery(self, a, q_list, out):
+        _dispatch(type(a), a, q_list, out, impls=_to_montgomery)
+        return out
+
+    def from_montgomery(self, a, q_list, out):
+        _dispatch(type(a), a, q_list, out, impls=_from_montgomery)
+        return out
+
+    def fused_modop(self, dtype):
+        return _dispatch(dtype, impls=_fused_modop)
+
     def reshape(self, device_tensor, new_shape):
         device_tensor.reshape(new_shape)
         return device_tensor
@@ -160,6 +259,42 @@ class PythonToCppDispatcher(ABC):
         _dispatch(type(a), a, b, p, out, impls=_modsum['ttc'])
         return out
 
+    def _modmuladd_ttt(self, a, b, c, p, out):
+        _dispatch(type(a), a, b, c, p, out, impls=_modmuladd['ttt'])
+        return out
+
+    def _modmuladd_tcc(self, a, b, c, p, out):
+        _dispatch(type(a), a, b, c, p, out, impls=_modmuladd['tcc'])
+        return out
+
+    def _modmuladd_tct(self, a, b, c, p, out):
+        _dispatch(type(a), a, b, c, p, out, impls=_modmuladd['tct'])
+        return out
+
+    def _modmuladd_ttc(self, a, b, c, p, out):
+        _dispatch(type(a), a, b, c, p, out, impls=_modmuladd['ttc'])
+        return out
+
+    def _modneg_tt(self, a, p, out):
+        _dispatch(type(a), a, p, out, impls=_modneg['tt'])
+        return out
+
+    def _modneg_tc(self, a, p, out):
+        _dispatch(type(a), a, p, out, impls=_modneg['tc'])
+        return out
+
+    def _mod_tt(self, a, b, out):
+        _dispatch(type(a), a, b, out, impls=_mod['tt'])
+        return out
+
+    def _mod_tc(self, a, b, out):
+        _dispatch(type(a), a, b, out, impls=_mod['tc'])
+        return out
+
+    def _mod_ct(self, a, b, out):
+        _dispatch(type(b), a, b, out, impls=_mod['ct'])
+        return out
+
     def expand(self, a, repeat, axis):
         return _dispatch(type(a), a, axis, repeat, impls=_expand_impls)
 
@@ -173,9 +308,7 @@ class PythonToCppDispatcher(ABC):
         return _dispatch(type(a), a, impls=_contiguous_impls)
 
     def ntt(self, a, perm, perm_pairs, q_list, log2p, mu_list, psi_arr, out, tile, skip_perm):
-        if skip_perm:
-            raise NotImplementedError(f"skip_perm is not supported. {skip_perm=}")
         if tile:
             a = self.expand(a, 2, -1)
-        _dispatch(type(a), a, q_list, perm, psi_arr, log2p, mu_list, out, impls=_ntt)
+        _dispatch(type(a), a, q_list, perm, psi_arr, log2p, mu_list, out, bool(skip_perm), impls=_ntt)
         return out
\ No newline at end of file
@@ -76,15 +76,101 @@ def _run_op(device_t_eng, memory_refs, op, verify):
         case _:
             raise ValueError(f"Unknown op type: {op[0]}")
 
-def run_transcript(device_t_eng, transcript, verify=False):
+def _device_tensor_names(arg):
+    if arg.arg_type == DeviceOpArgType.DEVICE_TENSOR:
+        return [arg.value.inf_name]
+    if arg.arg_type == DeviceOpArgType.SHAPE:
+        return [name for a in arg.value for name in _device_tensor_names(a)]
+    return []
+
+def _empty_bytes(op: DeviceOp):
+    shape, dtype = op.args[0], op.args[1]
+    if shape.arg_type != DeviceOpArgType.SHAPE or any(a.arg_type != DeviceOpArgType.INT for a in shape.value):
+        return None
+    numel = 1
+    for a in shape.value:
+        numel *= a.value
+    return numel * torch.empty((), dtype=dtype.value).element_size()
+
+def plan_transcript_memory(transcript):
+    """
+    Lifetimes of the buffers the transcript's `empty` ops allocate, as (bytes, first, last)
+    transcript positions in allocation order, or None if a shape is only known at run time.
+
+    A buffer stays alive while any name may refer to it. The output of every other op is
+    assumed to alias all of its device tensor arguments (views, and the `out` tensor that
+    compute ops return), and a name is dropped at its FREE_DEVICE_TENSOR or when an op
+    rebinds it. Buffers still named at the end live to the end of the transcript.
+    """
+    lifetimes = []                       # [bytes, first, last] per planned buffer
+    names: dict[str, set[int]] = {}      # name -> planned buffers it may refer to
+    refs: list[int] = []                 # names per planned buffer
+
+    def drop(name, i):
+        for b in names.pop(name, ()):
+            refs[b] -= 1
+            if refs[b] == 0:
+                lifetimes[b][2] = i
+
+    def bind(name, buffers, i):
+        for b in buffers:
+            refs[b] += 1
+        drop(name, i)
+        names[name] = buffers
+
+    for i, op in enumerate(transcript):
+        if op[0] == ExecutionTranscriptOpType.FREE_DEVICE_TENSOR:
+            drop(op[1].tensor_name, i)
+            continue
+        if op[0] != ExecutionTranscriptOpType.DEVICE_OP or op[1].name == 'device_to_host':
+            continue
+        device_op = op[1]
+        if device_op.name == 'empty':
+            nbytes = _empty_bytes(device_op)
+            if nbytes is None:
+                return None
+            lifetimes.append([nbytes, i, i])
+            refs.append(0)
+            bind(device_op.out.value.inf_name, {len(lifetimes) - 1}, i)
+        elif device_op.name == 'host_to_device':
+            bind(device_op.out.value.inf_name, set(), i)
+        else:
+            buffers = set()
+            for arg in device_op.args:
+                for name in _device_tensor_names(arg):
+                    buffers |= names.get(name, set())
+            bind(device_op.out.value.inf_name, buffers, i)
+
+    for b, count in enumerate(refs):
+        if count > 0:
+            lifetimes[b][2] = len(transcript)
+    return [tuple(l) for l in lifetimes]
+
+def run_transcript(device_t_eng, transcript, verify=False, plan_memory=False):
     print("\n\n######### Running transcript... #########")
     memory_refs: dict[str, DeviceTensorPointer] = {}
 
+    # plan_memory: place every `empty` buffer in one arena sized before execution starts
+    # (see memory_plan.h), instead of allocating them one by one from the pool
+    plan = None
+    if plan_memory:
+        lifetimes = plan_transcript_memory(transcript)
+        if lifetimes is None:
+            print("Memory plan skipped: an `empty` shape is only known at run time")
+        else:
+            plan = device_t_eng.begin_memory_plan(lifetimes)
+            print(f"Memory plan: {plan.num_buffers} buffers, peak footprint {plan.arena_bytes} bytes "
+                  f"(at most {plan.max_live_bytes} live at once)")
+
     start = time.time()
 
-    for i, op in enumerate(transcript):
-        # print(f"Running operation {i}")
-        _run_op(device_t_eng, memory_refs, op, verify)
+    try:
+        for i, op in enumerate(transcript):
+            # print(f"Running operation {i}")
+            _run_op(device_t_eng, memory_refs, op, verify)
+    finally:
+        if plan is not None:
+            device_t_eng.end_memory_plan()
 
     end = time.time()
 
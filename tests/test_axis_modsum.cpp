@@ -83,3 +83,113 @@ TEST(AxisModSumTests, ModulusShapeMismatchThrows) {
 
     EXPECT_THROW(axis_modsum(a_hw, p_hw, result_hw, 2), std::invalid_argument);
 }
+
+TEST(AxisModSumTests, LongAxisFewOutputs) {
+    // Few outputs over a long reduced axis: the axis itself is split across threads
+    torch::Tensor p = torch::tensor({(int64_t(1) << 40) + 15, 1000003, 3}, torch::kInt64);
+    torch::Tensor a = torch::randint(0, int64_t(1) << 40, {100000, 3}, torch::kInt64) % p;
+    torch::Tensor expected = a.sum(0) % p;
+
+    auto result_hw = allocate_on_hardware<int64_t>({3});
+    axis_modsum(host_to_device<int64_t>(a), host_to_device<int64_t>(p), result_hw, /*axis=*/0);
+    ASSERT_TRUE(torch::equal(device_to_host<int64_t>(result_hw), expected)) << "Long-axis modsum failed.";
+}
+
+TEST(AxisModSumTests, LargeModuliAndStridedInput) {
+    torch::Tensor p = torch::tensor({(int64_t(1) << 62) - 57, (int64_t(1) << 61) + 1}, torch::kInt64);
+    torch::Tensor a = torch::full({2, 9, 2}, (int64_t(1) << 61) - 1, torch::kInt64).transpose(0, 1);  // [9, 2, 2]
+    auto a_hw = host_to_device<int64_t>(a);
+    auto p_hw = host_to_device<int64_t>(p);
+    auto result_hw = allocate_on_hardware<int64_t>({2, 2});
+    axis_modsum(a_hw, p_hw, result_hw, /*axis=*/0);
+
+    // 9 * (2^61 - 1) overflows int64, so compare against the residue computed term by term
+    torch::Tensor result = device_to_host<int64_t>(result_hw);
+    for (int64_t t = 0; t < 2; ++t) {
+        const int64_t q = p[t].item<int64_t>();
+        int64_t expected = 0;
+        for (int r = 0; r < 9; ++r) expected = static_cast<int64_t>((static_cast<__int128>(expected) + ((int64_t(1) << 61) - 1)) % q);
+        EXPECT_EQ(result[0][t].item<int64_t>(), expected);
+        EXPECT_EQ(result[1][t].item<int64_t>(), expected);
+    }
+}
+
+TEST(AxisModSumTests, OutOfRangeTermsKeepChainedRemainder) {
+    // A term outside [0, p) gives the same result as sum = (sum + x) % p term by term
+    torch::Tensor a = torch::tensor({{5, 3}, {-9, 4}, {2, 12}}, torch::kInt64);
+    torch::Tensor p = torch::tensor({7, 5}, torch::kInt64);
+    auto result_hw = allocate_on_hardware<int64_t>({2});
+    axis_modsum(host_to_device<int64_t>(a), host_to_device<int64_t>(p), result_hw, /*axis=*/0);
+
+    // column 0: 5 → -4 → -2; column 1: 3 → 2 → 4
+    ASSERT_TRUE(torch::equal(device_to_host<int64_t>(result_hw), torch::tensor({-2, 4}, torch::kInt64)));
+}
+
+TEST(ModMulAxisSumTests, KeyBroadcastOverBatch) {
+    // a: [2, 3, 4] digits, b: [3, 4] key broadcast over the batch; reduce axis=1 → [2, 4]
+    torch::Tensor a = torch::randint(0, 11, {2, 3, 4}, torch::kInt32);
+    torch::Tensor b = torch::randint(0, 11, {3, 4}, torch::kInt32);
+    torch::Tensor p = torch::tensor({11, 13, 17, 19}, torch::kInt32);
+    torch::Tensor expected = (a * b).sum(1) % p;
+
+    auto result_hw = allocate_on_hardware<int32_t>({2, 4});
+    modmul_axis_sum(host_to_device<int32_t>(a), host_to_device<int32_t>(b), host_to_device<int32_t>(p),
+                    result_hw, /*axis=*/1);
+
+    torch::Tensor result = device_to_host<int32_t>(result_hw);
+    ASSERT_TRUE(torch::equal(result.to(torch::kInt64), expected.to(torch::kInt64))) << "modmul_axis_sum failed.";
+}
+
+TEST(ModMulAxisSumTests, LargeModuliAccumulateWithoutOverflow) {
+    // 64 products close to 2^124 wrap the 128-bit accumulator several times
+    const std::vector<int64_t> moduli = {(int64_t(1) << 62) - 57, (int64_t(1) << 62) - 87, 97};
+    const int64_t s = 64, k = static_cast<int64_t>(moduli.size());
+    torch::Tensor a = torch::empty({s, k}, torch::kInt64);
+    torch::Tensor b = torch::empty({s, k}, torch::kInt64);
+    for (int64_t t = 0; t < k; ++t) {
+        a.select(1, t).fill_(moduli[t] - 1 - t);
+        b.select(1, t).fill_(moduli[t] - 2);
+    }
+
+    auto result_hw = allocate_on_hardware<int64_t>({k});
+    modmul_axis_sum(host_to_device<int64_t>(a), host_to_device<int64_t>(b),
+                    host_to_device<int64_t>(torch::tensor(moduli, torch::kInt64)), result_hw, /*axis=*/0);
+
+    // (-1 - t) * (-2) * s mod p = 2 * (1 + t) * s
+    torch::Tensor result = device_to_host<int64_t>(result_hw);
+    for (int64_t t = 0; t < k; ++t) {
+        EXPECT_EQ(result[t].item<int64_t>(), (2 * (1 + t) * s) % moduli[t]) << "at " << t;
+    }
+}
+
+TEST(ModMulAxisSumTests, MatchesModMulThenAxisModSum) {
+    const std::vector<int64_t> moduli = {(int64_t(1) << 61) + 1, 1000003, 65537};
+    torch::Tensor p = torch::tensor(moduli, torch::kInt64);
+    torch::Tensor a = torch::randint(0, 65537, {5, 7, 3}, torch::kInt64).transpose(0, 1);  // [7, 5, 3], strided
+    torch::Tensor b = torch::randint(0, 65537, {7, 1, 3}, torch::kInt64);
+    auto a_hw = host_to_device<int64_t>(a);
+    auto b_hw = host_to_device<int64_t>(b);
+    auto p_hw = host_to_device<int64_t>(p);
+
+    auto product_hw = allocate_on_hardware<int64_t>({7, 5, 3});
+    auto expected_hw = allocate_on_hardware<int64_t>({5, 3});
+    modmul_ttt<int64_t>(a_hw, b_hw, p_hw, product_hw);
+    axis_modsum(product_hw, p_hw, expected_hw, /*axis=*/0);
+
+    auto result_hw = allocate_on_hardware<int64_t>({5, 3});
+    modmul_axis_sum(a_hw, b_hw, p_hw, result_hw, /*axis=*/0);
+    ASSERT_TRUE(torch::equal(device_to_host<int64_t>(result_hw), device_to_host<int64_t>(expected_hw)));
+}
+
+TEST(ModMulAxisSumTests, InvalidShapesThrow) {
+    auto a_hw = host_to_device<int32_t>(torch::randint(0, 7, {2, 3, 4}, torch::kInt32));
+    auto b_hw = host_to_device<int32_t>(torch::randint(0, 7, {3, 4}, torch::kInt32));
+    auto bad_b_hw = host_to_device<int32_t>(torch::randint(0, 7, {2, 4}, torch::kInt32));
+    auto p_hw = host_to_device<int32_t>(torch::tensor({7, 11, 13, 17}, torch::kInt32));
+    auto result_hw = allocate_on_hardware<int32_t>({2, 4});
+    auto bad_result_hw = allocate_on_hardware<int32_t>({2, 3});
+
+    EXPECT_THROW(modmul_axis_sum(a_hw, bad_b_hw, p_hw, result_hw, 1), std::invalid_argument);
+    EXPECT_THROW(modmul_axis_sum(a_hw, b_hw, p_hw, bad_result_hw, 1), std::invalid_argument);
+    EXPECT_THROW(modmul_axis_sum(a_hw, b_hw, p_hw, result_hw, 2), std::invalid_argument);
+}
@@ -0,0 +1,67 @@
+#include "gtest/gtest.h"
+#include "lattica_hw_api.h"
+#include <torch/torch.h>
+
+using namespace lattica_hw_api;
+
+TEST(FusedModopTests, ChainMatchesSequentialOps) {
+    auto p = torch::tensor({1000003, 65537, 97, 12289}, torch::kInt64);
+    auto a = torch::randint(0, 97, {300, 4}, torch::kInt64);
+    auto b = torch::randint(0, 97, {300, 4}, torch::kInt64);
+    auto c = torch::randint(0, 97, {1, 4}, torch::kInt64);
+    auto p_hw = host_to_device<int64_t>(p);
+    auto a_hw = host_to_device<int64_t>(a);
+    auto b_hw = host_to_device<int64_t>(b);
+    auto c_hw = host_to_device<int64_t>(c);
+
+    // ((a * b + c) % 89) * b, one modulus per column except for the remainder
+    FusedModop<int64_t> f;
+    auto pa = f.input(p_hw), na = f.input(a_hw), nb = f.input(b_hw), nc = f.input(c_hw);
+    auto x = f.modsum(f.modmul(na, nb, pa), nc, pa);
+    auto y = f.modmul(f.mod(x, f.scalar(89)), nb, pa);
+
+    auto result_hw = allocate_on_hardware<int64_t>({300, 4});
+    f.evaluate(y, result_hw);
+    auto expected = ((((a * b) % p + c) % p) % 89 * b) % p;
+    ASSERT_TRUE(torch::equal(device_to_host<int64_t>(result_hw), expected));
+
+    // Intermediate nodes can be evaluated on their own
+    f.evaluate(x, result_hw);
+    ASSERT_TRUE(torch::equal(device_to_host<int64_t>(result_hw), ((a * b) % p + c) % p));
+}
+
+TEST(FusedModopTests, NonContiguousAndInPlace) {
+    auto p = torch::tensor({7681, 12289, 40961}, torch::kInt32);
+    auto a = torch::randint(0, 7681, {3, 2000}, torch::kInt32);
+    auto b = torch::randint(0, 7681, {2000, 3}, torch::kInt32);
+    auto p_hw = host_to_device<int32_t>(p);
+    auto a_hw = host_to_device<int32_t>(a.t());  // keeps the transposed strides
+    auto b_hw = host_to_device<int32_t>(b);
+
+    FusedModop<int32_t> f;
+    auto pa = f.input(p_hw), na = f.input(a_hw), nb = f.input(b_hw);
+    auto y = f.modsum(f.modmul(na, nb, pa), f.scalar(1), pa);
+    f.evaluate(y, b_hw);
+    auto expected = ((a.t() * b) % p + 1) % p;
+    ASSERT_TRUE(torch::equal(device_to_host<int32_t>(b_hw), expected));
+}
+
+TEST(FusedModopTests, InvalidGraphsThrow) {
+    auto a_hw = host_to_device<int64_t>(torch::randint(0, 10, {2, 3}, torch::kInt64));
+    auto p_hw = host_to_device<int64_t>(torch::tensor({11, 13, 17}, torch::kInt64));
+    auto result_hw = allocate_on_hardware<int64_t>({2, 3});
+
+    FusedModop<int64_t> f;
+    auto na = f.input(a_hw), pa = f.input(p_hw);
+    auto x = f.modmul(na, na, pa);
+    EXPECT_THROW(f.modsum(na, 5, pa), std::invalid_argument);
+    EXPECT_THROW(f.modsum(na, na, x), std::invalid_argument);  // modulus must be a leaf
+
+    auto wide = allocate_on_hardware<int64_t>({2, 4});
+    EXPECT_THROW(f.evaluate(x, wide), std::invalid_argument);
+
+    auto a_m = allocate_on_hardware<int64_t>({2, 3});
+    to_montgomery<int64_t>(a_hw, p_hw, a_m);
+    ASSERT_TRUE(is_montgomery<int64_t>(a_m));
+    EXPECT_THROW(f.evaluate(f.modsum(f.input(a_m), na, pa), result_hw), std::invalid_argument);
+}
@@ -0,0 +1,32 @@
+#include "gtest/gtest.h"
+#include "lattica_hw_api.h"
+#include <torch/torch.h>
+
+using namespace lattica_hw_api;
+
+TEST(HostDeviceTests, CopyIsIndependentOfHostTensor) {
+    auto a = torch::arange(12, torch::kInt64).reshape({3, 4});
+    auto a_hw = host_to_device<int64_t>(a);
+    modsum_tcc<int64_t>(a_hw, 1, 1000, a_hw);
+    ASSERT_TRUE(torch::equal(a, torch::arange(12, torch::kInt64).reshape({3, 4})));
+
+    auto host = device_to_host<int64_t>(a_hw);
+    host.fill_(0);
+    ASSERT_TRUE(torch::equal(device_to_host<int64_t>(a_hw), a + 1));
+}
+
+TEST(HostDeviceTests, ZeroCopySharesStorage) {
+    auto a = torch::arange(12, torch::kInt64).reshape({4, 3}).t();  // non-contiguous view
+    auto expected = a + 1;
+    auto a_hw = host_to_device<int64_t>(a, /*zero_copy=*/true);
+
+    // Device-side writes land in the host tensor
+    modsum_tcc<int64_t>(a_hw, 1, 1000, a_hw);
+    ASSERT_TRUE(torch::equal(a, expected));
+
+    // The view outlives both the host tensor and the DeviceTensor
+    a = torch::Tensor();
+    auto view = device_to_host<int64_t>(a_hw, /*view=*/true);
+    a_hw.reset();
+    ASSERT_TRUE(torch::equal(view, expected));
+}
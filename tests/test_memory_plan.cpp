@@ -0,0 +1,81 @@
+#include "gtest/gtest.h"
+#include "lattica_hw_api.h"
+#include <torch/torch.h>
+
+using namespace lattica_hw_api;
+
+namespace {
+
+bool overlaps(const MemoryPlan& plan, int64_t i, int64_t j) {
+    const BufferLifetime& a = plan.buffer(i);
+    const BufferLifetime& b = plan.buffer(j);
+    const bool same_time = a.first <= b.last && b.first <= a.last;
+    const bool same_bytes = plan.offset(i) < plan.offset(j) + b.bytes && plan.offset(j) < plan.offset(i) + a.bytes;
+    return same_time && same_bytes;
+}
+
+char* address(const std::shared_ptr<DeviceTensor<int64_t>>& tensor) {
+    return static_cast<char*>(device_to_host<int64_t>(tensor, true).data_ptr());
+}
+
+} // namespace
+
+TEST(MemoryPlanTests, LiveBuffersDoNotOverlap) {
+    // A chain of temporaries: each one is consumed by the next step
+    std::vector<BufferLifetime> buffers;
+    for (int64_t i = 0; i < 40; ++i) buffers.push_back({(i % 5 + 1) * 1000, i, i + 1});
+    buffers.push_back({4096, 0, 40});   // alive throughout
+    buffers.push_back({0, 3, 3});       // empty
+    MemoryPlan plan(buffers);
+
+    for (int64_t i = 0; i < plan.num_buffers(); ++i) {
+        EXPECT_EQ(plan.offset(i) % memory_pool_alignment, 0);
+        EXPECT_LE(plan.offset(i) + plan.buffer(i).bytes, plan.arena_bytes());
+        for (int64_t j = 0; j < i; ++j) EXPECT_FALSE(overlaps(plan, i, j)) << i << " " << j;
+    }
+    // Two temporaries of at most 5000 bytes plus the long-lived one, far below the 40
+    // buffers' total
+    EXPECT_GE(plan.arena_bytes(), plan.max_live_bytes());
+    EXPECT_LE(plan.max_live_bytes(), 2 * 5056 + 4096);
+    EXPECT_LE(plan.arena_bytes(), 3 * 5056 + 4096);
+
+    EXPECT_THROW(MemoryPlan({{8, 2, 1}}), std::invalid_argument);
+    EXPECT_THROW(MemoryPlan({{-8, 0, 1}}), std::invalid_argument);
+}
+
+TEST(MemoryPlanTests, AllocationsFollowThePlan) {
+    MemoryPlan plan({{800, 0, 1}, {800, 1, 2}, {800, 2, 3}});
+    ASSERT_EQ(plan.offset(0), plan.offset(2));  // the first buffer is dead by step 2
+
+    begin_memory_plan(plan);
+    auto a_hw = allocate_on_hardware<int64_t>({100});
+    auto b_hw = allocate_on_hardware<int64_t>({10, 10});
+    modsum_tcc<int64_t>(a_hw, 3, 97, a_hw);
+    modsum_tcc<int64_t>(b_hw, 4, 97, b_hw);
+    EXPECT_EQ(address(b_hw) - address(a_hw), plan.offset(1) - plan.offset(0));
+    EXPECT_EQ(memory_plan_position(), 2);
+
+    char* a_address = address(a_hw);
+    a_hw.reset();
+    auto c_hw = allocate_on_hardware<int64_t>({100});
+    EXPECT_EQ(address(c_hw), a_address);
+    ASSERT_TRUE(torch::equal(device_to_host<int64_t>(c_hw), torch::zeros({100}, torch::kInt64)));
+    ASSERT_TRUE(torch::equal(device_to_host<int64_t>(b_hw), torch::full({10, 10}, 4, torch::kInt64)));
+
+    // Past the last planned buffer, allocations come from the pool again
+    auto d_hw = allocate_on_hardware<int64_t>({100});
+    EXPECT_EQ(memory_plan_position(), 3);
+    end_memory_plan();
+    EXPECT_EQ(memory_plan_position(), -1);
+
+    // The arena outlives the plan while its tensors do
+    ASSERT_TRUE(torch::equal(device_to_host<int64_t>(b_hw), torch::full({10, 10}, 4, torch::kInt64)));
+}
+
+TEST(MemoryPlanTests, OversizedAllocationThrows) {
+    begin_memory_plan(MemoryPlan({{64, 0, 0}}));
+    EXPECT_THROW(allocate_on_hardware<int64_t>({9}), std::runtime_error);
+    auto a_hw = allocate_on_hardware<int32_t>({16});
+    EXPECT_EQ(memory_plan_position(), 1);
+    end_memory_plan();
+}
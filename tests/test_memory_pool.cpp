@@ -0,0 +1,100 @@
+#include "gtest/gtest.h"
+#include "lattica_hw_api.h"
+#include <torch/torch.h>
+
+using namespace lattica_hw_api;
+
+TEST(MemoryPoolTests, ReleasedBuffersAreReused) {
+    release_memory_pool_cache();
+    reset_memory_pool_stats();
+    {
+        auto a_hw = allocate_on_hardware<int64_t>({100, 7});
+        auto ones = torch::ones({100, 7}, torch::kInt64);
+        modsum_tcc<int64_t>(a_hw, 1, 97, a_hw);
+        ASSERT_TRUE(torch::equal(device_to_host<int64_t>(a_hw), ones));
+    }
+    MemoryPoolStats stats = get_memory_pool_stats();
+    EXPECT_EQ(stats.misses, 1);
+    EXPECT_EQ(stats.live_bytes, 0);
+    EXPECT_GE(stats.cached_bytes, 100 * 7 * 8);
+
+    // Same size class: served from the free list, and zero-filled again
+    auto b_hw = allocate_on_hardware<int32_t>({1399});
+    ASSERT_TRUE(torch::equal(device_to_host<int32_t>(b_hw), torch::zeros({1399}, torch::kInt32)));
+    stats = get_memory_pool_stats();
+    EXPECT_EQ(stats.hits, 1);
+    EXPECT_EQ(stats.misses, 1);
+    EXPECT_EQ(stats.cached_bytes, 0);
+    EXPECT_EQ(stats.live_bytes, stats.peak_live_bytes);
+}
+
+TEST(MemoryPoolTests, CacheLimit) {
+    const int64_t limit = get_memory_pool_cache_limit();
+    set_memory_pool_cache_limit(0);
+    { auto a_hw = allocate_on_hardware<int32_t>({64}); }
+    EXPECT_EQ(get_memory_pool_stats().cached_bytes, 0);
+
+    set_memory_pool_cache_limit(limit);
+    { auto a_hw = allocate_on_hardware<int32_t>({64}); }
+    EXPECT_GT(get_memory_pool_stats().cached_bytes, 0);
+    release_memory_pool_cache();
+    EXPECT_EQ(get_memory_pool_stats().cached_bytes, 0);
+
+    EXPECT_THROW(set_memory_pool_cache_limit(-1), std::invalid_argument);
+}
+
+TEST(MemoryPoolTests, HugePagePolicy) {
+    const HugePageMode mode = get_memory_pool_huge_page_mode();
+    const int64_t threshold = get_memory_pool_huge_page_threshold();
+
+    set_memory_pool_huge_pages(HugePageMode::transparent, int64_t(1) << 21);
+    release_memory_pool_cache();
+    {
+        // Large and small buffers alike are zero-filled and usable
+        auto big_hw = allocate_on_hardware<int64_t>({1 << 19});
+        auto small_hw = allocate_on_hardware<int64_t>({3});
+        modsum_tcc<int64_t>(big_hw, 5, 97, big_hw);
+        ASSERT_TRUE(torch::equal(device_to_host<int64_t>(big_hw), torch::full({1 << 19}, 5, torch::kInt64)));
+        ASSERT_TRUE(torch::equal(device_to_host<int64_t>(small_hw), torch::zeros({3}, torch::kInt64)));
+    }
+    EXPECT_EQ(get_memory_pool_huge_page_mode(), HugePageMode::transparent);
+    EXPECT_THROW(set_memory_pool_huge_pages(HugePageMode::off, -1), std::invalid_argument);
+
+    set_memory_pool_huge_pages(mode, threshold);
+    release_memory_pool_cache();
+}
+
+TEST(MemoryPoolTests, NumaPolicy) {
+    const NumaPolicy policy = get_memory_pool_numa_policy();
+    const int nodes = numa_node_count();
+    ASSERT_GE(nodes, 1);
+
+    // First touch: filled buffers hold the expected values and sit on some node (or -1
+    // when the node cannot be queried)
+    set_memory_pool_numa_policy(NumaPolicy::first_touch);
+    auto a = torch::randint(0, 97, {1 << 18}, torch::kInt64);
+    auto a_hw = host_to_device<int64_t>(a);
+    auto z_hw = allocate_on_hardware<int64_t>({1 << 18});
+    ASSERT_TRUE(torch::equal(device_to_host<int64_t>(a_hw), a));
+    ASSERT_TRUE(torch::equal(device_to_host<int64_t>(z_hw), torch::zeros({1 << 18}, torch::kInt64)));
+    EXPECT_LT(numa_node_of<int64_t>(a_hw), nodes);
+    EXPECT_GE(numa_node_of<int64_t>(a_hw), -1);
+
+    EXPECT_THROW(set_memory_pool_numa_policy(NumaPolicy::bind, nodes), std::exception);
+    try {
+        set_memory_pool_numa_policy(NumaPolicy::bind, nodes - 1);
+    } catch (const std::runtime_error&) {
+        GTEST_SKIP() << "built without libnuma";
+    }
+    EXPECT_EQ(get_memory_pool_numa_node(), nodes - 1);
+    release_memory_pool_cache();
+    {
+        auto b_hw = allocate_on_hardware<int64_t>({1 << 19});
+        modsum_tcc<int64_t>(b_hw, 5, 97, b_hw);
+        ASSERT_TRUE(torch::equal(device_to_host<int64_t>(b_hw), torch::full({1 << 19}, 5, torch::kInt64)));
+        EXPECT_EQ(numa_node_of<int64_t>(b_hw), nodes - 1);
+    }
+
+    set_memory_pool_numa_policy(policy);
+    release_memory_pool_cache();
+}
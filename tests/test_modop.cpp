@@ -1,6 +1,10 @@
 #include "gtest/gtest.h"
 #include "lattica_hw_api.h"
 #include <torch/torch.h>
+#include <cstdlib>
+#include <limits>
+#include <random>
+#include <type_traits>
 
 using namespace lattica_hw_api;
 
@@ -484,3 +488,376 @@ TEST(ModCTTests, ShapeMismatchThrows) {
     auto result_hw = allocate_on_hardware<int64_t>({3,2});     // wrong result shape
     EXPECT_THROW(mod_ct<int64_t>(5, b_hw, result_hw), std::invalid_argument);
 }
+
+/***************************************************************************************
+****************************************************************************************
+****                                                                                ****
+****                         CONTIGUOUS FAST PATH TESTS                             ****
+****                                                                                ****
+****************************************************************************************
+****************************************************************************************/
+
+namespace {
+
+// Runs every mul/add variant on contiguous [rows, k] operands and compares with a
+// double-width reference, including operands outside [0, p).
+template <typename T>
+void check_contiguous_modops(const std::vector<T>& moduli, int64_t rows, bool out_of_range) {
+    using Wide = std::conditional_t<sizeof(T) == 4, int64_t, __int128>;
+    const auto dtype = sizeof(T) == 4 ? torch::kInt32 : torch::kInt64;
+    const int64_t k = static_cast<int64_t>(moduli.size());
+    const int64_t n = rows * k;
+
+    std::mt19937_64 rng(17);
+    std::vector<T> a(n), b(n);
+    for (int64_t i = 0; i < n; ++i) {
+        a[i] = static_cast<T>(rng() % static_cast<uint64_t>(moduli[i % k]));
+        b[i] = static_cast<T>(rng() % static_cast<uint64_t>(moduli[i % k]));
+        if (out_of_range && i % 37 == 0) a[i] = -a[i] - 1;
+        if (out_of_range && i % 41 == 0) b[i] = std::numeric_limits<T>::max() - b[i];
+    }
+
+    auto to_device = [&](std::vector<T>& v, std::vector<int64_t> shape) {
+        return host_to_device<T>(torch::from_blob(v.data(), shape, dtype).clone());
+    };
+    std::vector<T> p(moduli);
+    auto a_hw = to_device(a, {rows, k});
+    auto b_hw = to_device(b, {rows, k});
+    auto p_hw = to_device(p, {k});
+    auto result_hw = allocate_on_hardware<T>({rows, k});
+    const T b_scalar = b[1], p_scalar = moduli[0];
+
+    auto expect = [&](bool mul, bool scalar_b, bool scalar_p, const std::string& name) {
+        const torch::Tensor out = device_to_host<T>(result_hw).contiguous();
+        const T* values = out.data_ptr<T>();
+        for (int64_t i = 0; i < n; ++i) {
+            const T y = scalar_b ? b_scalar : b[i];
+            const T q = scalar_p ? p_scalar : moduli[i % k];
+            const Wide v = mul ? static_cast<Wide>(a[i]) * y : static_cast<Wide>(a[i]) + y;
+            ASSERT_EQ(values[i], static_cast<T>(v % q)) << name << " at " << i;
+        }
+    };
+    modmul_ttt<T>(a_hw, b_hw, p_hw, result_hw);  expect(true, false, false, "modmul_ttt");
+    modmul_ttc<T>(a_hw, b_hw, p_scalar, result_hw);  expect(true, false, true, "modmul_ttc");
+    modmul_tct<T>(a_hw, b_scalar, p_hw, result_hw);  expect(true, true, false, "modmul_tct");
+    modmul_tcc<T>(a_hw, b_scalar, p_scalar, result_hw);  expect(true, true, true, "modmul_tcc");
+    modsum_ttt<T>(a_hw, b_hw, p_hw, result_hw);  expect(false, false, false, "modsum_ttt");
+    modsum_ttc<T>(a_hw, b_hw, p_scalar, result_hw);  expect(false, false, true, "modsum_ttc");
+    modsum_tct<T>(a_hw, b_scalar, p_hw, result_hw);  expect(false, true, false, "modsum_tct");
+    modsum_tcc<T>(a_hw, b_scalar, p_scalar, result_hw);  expect(false, true, true, "modsum_tcc");
+}
+
+} // namespace
+
+TEST(ModOpContiguous, Int64ModuliUpToBarrettBound) {
+    const std::vector<int64_t> moduli = {
+        (int64_t(1) << 62) - 57, (int64_t(1) << 61) + 1, (int64_t(1) << 61) - 1, 1000003, 3};
+    check_contiguous_modops<int64_t>(moduli, 333, false);
+}
+
+TEST(ModOpContiguous, Int32ModuliUpToBarrettBound) {
+    const std::vector<int32_t> moduli = {(1 << 30) - 35, (1 << 29) + 11, 65537, 97, 2, 7, 13};
+    check_contiguous_modops<int32_t>(moduli, 211, false);
+}
+
+TEST(ModOpContiguous, ModuliOutsideBarrettRangeUseGenericPath) {
+    check_contiguous_modops<int64_t>({int64_t(1) << 62, (int64_t(1) << 62) + 1}, 50, false);
+    check_contiguous_modops<int32_t>({std::numeric_limits<int32_t>::max(), 1 << 29}, 50, false);
+}
+
+TEST(ModOpContiguous, OutOfRangeOperandsKeepRemainderSemantics) {
+    check_contiguous_modops<int64_t>({(int64_t(1) << 50) + 55, 17}, 400, true);
+    check_contiguous_modops<int32_t>({(1 << 30) - 35, 17, 101}, 400, true);
+}
+
+// The default compile-time moduli (example_impl/modulus_registry.h) run on the
+// specialized kernels when no vector level is in use; a partly registered set does not.
+TEST(ModOpContiguous, RegisteredModuliOnScalarLevel) {
+    const std::vector<int64_t> primes64 = {1152921504606584833LL, 1152921504598720513LL,
+                                           1152921504597016577LL, 1152921504595968001LL};
+    const std::vector<int32_t> primes32 = {1073479681, 1071513601, 1070727169, 1068236801};
+    setenv("LATTICA_SIMD", "scalar", 1);
+    check_contiguous_modops<int64_t>(primes64, 333, false);
+    check_contiguous_modops<int64_t>(primes64, 333, true);
+    check_contiguous_modops<int64_t>({primes64[2]}, 100, true);
+    check_contiguous_modops<int32_t>(primes32, 211, true);
+    check_contiguous_modops<int64_t>({primes64[0], 97}, 50, true);
+    unsetenv("LATTICA_SIMD");
+}
+
+TEST(ModOpContiguous, BroadcastOperandWithLargeModuli) {
+    // b is broadcast along the last axis, so the op takes the strided path
+    const std::vector<int64_t> moduli = {(int64_t(1) << 62) - 57, (int64_t(1) << 61) + 1, 1000003, 97};
+    const int64_t rows = 129, k = static_cast<int64_t>(moduli.size());
+    auto a = torch::randint(0, 97, {rows, k}, torch::kInt64);
+    auto b = torch::randint(0, 97, {rows, 1}, torch::kInt64);
+    a.select(1, 0).random_(0, int64_t(1) << 62);
+    a.select(1, 1).random_(0, int64_t(1) << 61);
+
+    auto p_hw = host_to_device<int64_t>(torch::tensor(moduli, torch::kInt64));
+    auto result_hw = allocate_on_hardware<int64_t>({rows, k});
+    modmul_ttt<int64_t>(host_to_device<int64_t>(a), host_to_device<int64_t>(b), p_hw, result_hw);
+
+    const torch::Tensor out = device_to_host<int64_t>(result_hw).contiguous();
+    auto a_acc = a.accessor<int64_t, 2>();
+    auto b_acc = b.accessor<int64_t, 2>();
+    auto out_acc = out.accessor<int64_t, 2>();
+    for (int64_t i = 0; i < rows; ++i) {
+        for (int64_t t = 0; t < k; ++t) {
+            const __int128 v = static_cast<__int128>(a_acc[i][t]) * b_acc[i][0];
+            ASSERT_EQ(out_acc[i][t], static_cast<int64_t>(v % moduli[t])) << "at " << i << ", " << t;
+        }
+    }
+}
+
+TEST(ModOpContiguous, ModuliRewrittenInPlaceAreNotReusedFromCache) {
+    auto a = torch::randint(0, 1000, {64, 3}, torch::kInt64);
+    auto b = torch::randint(0, 1000, {64, 3}, torch::kInt64);
+    auto a_hw = host_to_device<int64_t>(a);
+    auto b_hw = host_to_device<int64_t>(b);
+    auto p_hw = host_to_device<int64_t>(torch::tensor({1009, 1013, 1019}, torch::kInt64));
+    auto result_hw = allocate_on_hardware<int64_t>({64, 3});
+
+    modmul_ttt<int64_t>(a_hw, b_hw, p_hw, result_hw);
+    ASSERT_TRUE(torch::equal(device_to_host<int64_t>(result_hw),
+                             (a * b).remainder(torch::tensor({1009, 1013, 1019}, torch::kInt64))));
+
+    // Same buffer, new moduli: 1009 + 12 = 1021, 1013 + 12 = 1025, 1019 + 12 = 1031
+    modsum_tcc<int64_t>(p_hw, 12, 1 << 20, p_hw);
+    modmul_ttt<int64_t>(a_hw, b_hw, p_hw, result_hw);
+    ASSERT_TRUE(torch::equal(device_to_host<int64_t>(result_hw),
+                             (a * b).remainder(torch::tensor({1021, 1025, 1031}, torch::kInt64))));
+}
+
+/***************************************************************************************
+****************************************************************************************
+****                                                                                ****
+****                              MODMULADD TESTS                                   ****
+****                                                                                ****
+****************************************************************************************
+****************************************************************************************/
+
+TEST(ModMulAddTests, AllVariantsSmallModuli) {
+    auto a = torch::tensor({{1, 2, 3}, {4, 5, 6}}, torch::kInt32);
+    auto b = torch::tensor({{7, 8, 9}, {10, 11, 12}}, torch::kInt32);
+    auto c = torch::tensor({{3, 1, 4}, {1, 5, 9}}, torch::kInt32);
+    auto p = torch::tensor({11, 13, 17}, torch::kInt32);
+    auto a_hw = host_to_device<int32_t>(a);
+    auto b_hw = host_to_device<int32_t>(b);
+    auto c_hw = host_to_device<int32_t>(c);
+    auto p_hw = host_to_device<int32_t>(p);
+    auto result_hw = allocate_on_hardware<int32_t>({2, 3});
+
+    modmuladd_ttt<int32_t>(a_hw, b_hw, c_hw, p_hw, result_hw);
+    ASSERT_TRUE(torch::equal(device_to_host<int32_t>(result_hw), (a * b + c) % p)) << "modmuladd_ttt failed";
+    modmuladd_ttc<int32_t>(a_hw, b_hw, c_hw, 7, result_hw);
+    ASSERT_TRUE(torch::equal(device_to_host<int32_t>(result_hw), (a * b + c) % 7)) << "modmuladd_ttc failed";
+    modmuladd_tct<int32_t>(a_hw, 5, c_hw, p_hw, result_hw);
+    ASSERT_TRUE(torch::equal(device_to_host<int32_t>(result_hw), (a * 5 + c) % p)) << "modmuladd_tct failed";
+    modmuladd_tcc<int32_t>(a_hw, 5, c_hw, 7, result_hw);
+    ASSERT_TRUE(torch::equal(device_to_host<int32_t>(result_hw), (a * 5 + c) % 7)) << "modmuladd_tcc failed";
+}
+
+TEST(ModMulAddTests, MatchesModMulThenModSum) {
+    const std::vector<int64_t> moduli = {(int64_t(1) << 62) - 57, (int64_t(1) << 61) + 1, 1000003, 97, 3};
+    const int64_t rows = 257, k = static_cast<int64_t>(moduli.size());
+    auto p = torch::tensor(moduli, torch::kInt64);
+    auto a = (torch::rand({rows, k}, torch::kFloat64) * p.to(torch::kFloat64)).to(torch::kInt64) % p;
+    auto b = (torch::rand({rows, k}, torch::kFloat64) * p.to(torch::kFloat64)).to(torch::kInt64) % p;
+    auto c = (torch::rand({rows, k}, torch::kFloat64) * p.to(torch::kFloat64)).to(torch::kInt64) % p;
+    auto a_hw = host_to_device<int64_t>(a);
+    auto b_hw = host_to_device<int64_t>(b);
+    auto c_hw = host_to_device<int64_t>(c);
+    auto p_hw = host_to_device<int64_t>(p);
+
+    auto expected_hw = allocate_on_hardware<int64_t>({rows, k});
+    modmul_ttt<int64_t>(a_hw, b_hw, p_hw, expected_hw);
+    modsum_ttt<int64_t>(expected_hw, c_hw, p_hw, expected_hw);
+    const torch::Tensor expected = device_to_host<int64_t>(expected_hw);
+
+    auto result_hw = allocate_on_hardware<int64_t>({rows, k});
+    modmuladd_ttt<int64_t>(a_hw, b_hw, c_hw, p_hw, result_hw);
+    ASSERT_TRUE(torch::equal(device_to_host<int64_t>(result_hw), expected));
+
+    // Transposed a and c take the strided path
+    auto a_t_hw = host_to_device<int64_t>(a.t().contiguous().t());
+    auto c_t_hw = host_to_device<int64_t>(c.t().contiguous().t());
+    modmuladd_ttt<int64_t>(a_t_hw, b_hw, c_t_hw, p_hw, result_hw);
+    ASSERT_TRUE(torch::equal(device_to_host<int64_t>(result_hw), expected));
+
+    // Accumulating in place into c
+    modmuladd_ttt<int64_t>(a_hw, b_hw, c_hw, p_hw, c_hw);
+    ASSERT_TRUE(torch::equal(device_to_host<int64_t>(c_hw), expected));
+}
+
+TEST(ModMulAddTests, OutOfRangeOperandsReduceOnce) {
+    // (a * b + c) % p in double width, not ((a * b) % p + c) % p
+    auto a = torch::tensor({{-8, 3, 1000}}, torch::kInt64);
+    auto b = torch::tensor({{1, -5, 1000}}, torch::kInt64);
+    auto c = torch::tensor({{4, 2, -7}}, torch::kInt64);
+    auto result_hw = allocate_on_hardware<int64_t>({1, 3});
+    modmuladd_ttc<int64_t>(host_to_device<int64_t>(a), host_to_device<int64_t>(b),
+                           host_to_device<int64_t>(c), 5, result_hw);
+    auto expected = torch::tensor({{-4 % 5, -13 % 5, 999993 % 5}}, torch::kInt64);
+    ASSERT_TRUE(torch::equal(device_to_host<int64_t>(result_hw), expected));
+}
+
+TEST(ModMulAddTests, IncompatibleAddendShapeThrows) {
+    auto a_hw = host_to_device<int32_t>(torch::randint(0, 10, {2, 3}, torch::kInt32));
+    auto b_hw = host_to_device<int32_t>(torch::randint(0, 10, {2, 3}, torch::kInt32));
+    auto c_hw = host_to_device<int32_t>(torch::randint(0, 10, {2, 4}, torch::kInt32));
+    auto result_hw = allocate_on_hardware<int32_t>({2, 3});
+    EXPECT_THROW(modmuladd_ttc<int32_t>(a_hw, b_hw, c_hw, 11, result_hw), std::invalid_argument);
+}
+
+// ---------- Montgomery form ----------
+
+TEST(ModMontgomeryTests, ProductChainMatchesPlainModMul) {
+    const std::vector<int64_t> moduli = {(int64_t(1) << 62) - 57, (int64_t(1) << 61) + 1, 1000003, 97, 3};
+    const int64_t rows = 257, k = static_cast<int64_t>(moduli.size());
+    auto p = torch::tensor(moduli, torch::kInt64);
+    auto a = (torch::rand({rows, k}, torch::kFloat64) * p.to(torch::kFloat64)).to(torch::kInt64) % p;
+    auto b = (torch::rand({rows, k}, torch::kFloat64) * p.to(torch::kFloat64)).to(torch::kInt64) % p;
+    auto a_hw = host_to_device<int64_t>(a);
+    auto b_hw = host_to_device<int64_t>(b);
+    auto p_hw = host_to_device<int64_t>(p);
+
+    // Plain reference: a * b * b
+    auto expected_hw = allocate_on_hardware<int64_t>({rows, k});
+    modmul_ttt<int64_t>(a_hw, b_hw, p_hw, expected_hw);
+    modmul_ttt<int64_t>(expected_hw, b_hw, p_hw, expected_hw);
+    const torch::Tensor expected = device_to_host<int64_t>(expected_hw);
+
+    auto a_m = allocate_on_hardware<int64_t>({rows, k});
+    auto b_m = allocate_on_hardware<int64_t>({rows, k});
+    to_montgomery<int64_t>(a_hw, p_hw, a_m);
+    to_montgomery<int64_t>(b_hw, p_hw, b_m);
+    ASSERT_TRUE(is_montgomery<int64_t>(a_m));
+
+    auto result_hw = allocate_on_hardware<int64_t>({rows, k});
+    modmul_ttt<int64_t>(a_m, b_m, p_hw, result_hw);
+    modmul_ttt<int64_t>(result_hw, b_m, p_hw, result_hw);
+    ASSERT_TRUE(is_montgomery<int64_t>(result_hw));
+    from_montgomery<int64_t>(result_hw, p_hw, result_hw);
+    ASSERT_FALSE(is_montgomery<int64_t>(result_hw));
+    ASSERT_TRUE(torch::equal(device_to_host<int64_t>(result_hw), expected));
+
+    // Round trip, and a Montgomery tensor times a plain one
+    from_montgomery<int64_t>(a_m, p_hw, result_hw);
+    ASSERT_TRUE(torch::equal(device_to_host<int64_t>(result_hw), a));
+    modmul_ttt<int64_t>(a_m, b_hw, p_hw, result_hw);
+    ASSERT_TRUE(is_montgomery<int64_t>(result_hw));
+    from_montgomery<int64_t>(result_hw, p_hw, result_hw);
+    modmul_ttt<int64_t>(a_hw, b_hw, p_hw, expected_hw);
+    ASSERT_TRUE(torch::equal(device_to_host<int64_t>(result_hw), device_to_host<int64_t>(expected_hw)));
+}
+
+TEST(ModMontgomeryTests, SumsAndBroadcastOperands) {
+    auto p = torch::tensor({1000003, 65537, 97}, torch::kInt32);
+    auto a = torch::randint(0, 97, {6, 3}, torch::kInt32);
+    auto b = torch::randint(0, 97, {1, 3}, torch::kInt32);
+    auto p_hw = host_to_device<int32_t>(p);
+    auto a_m = allocate_on_hardware<int32_t>({6, 3});
+    auto b_m = allocate_on_hardware<int32_t>({1, 3});
+    to_montgomery<int32_t>(host_to_device<int32_t>(a), p_hw, a_m);
+    to_montgomery<int32_t>(host_to_device<int32_t>(b), p_hw, b_m);
+
+    auto result_hw = allocate_on_hardware<int32_t>({6, 3});
+    modsum_ttt<int32_t>(a_m, b_m, p_hw, result_hw);
+    from_montgomery<int32_t>(result_hw, p_hw, result_hw);
+    ASSERT_TRUE(torch::equal(device_to_host<int32_t>(result_hw), (a + b) % p));
+
+    modmul_ttt<int32_t>(a_m, b_m, p_hw, result_hw);
+    from_montgomery<int32_t>(result_hw, p_hw, result_hw);
+    ASSERT_TRUE(torch::equal(device_to_host<int32_t>(result_hw), (a * b) % p));
+
+    // A plain scalar is converted before it is added
+    modsum_tct<int32_t>(a_m, 5, p_hw, result_hw);
+    ASSERT_TRUE(is_montgomery<int32_t>(result_hw));
+    from_montgomery<int32_t>(result_hw, p_hw, result_hw);
+    ASSERT_TRUE(torch::equal(device_to_host<int32_t>(result_hw), (a + 5) % p));
+}
+
+TEST(ModMontgomeryTests, NegativeOperandsGiveResidues) {
+    auto p = torch::tensor({1000003, 97}, torch::kInt64);
+    auto a = torch::randint(0, 97, {40, 2}, torch::kInt64);
+    auto b = torch::full({40, 2}, -3, torch::kInt64);
+    auto p_hw = host_to_device<int64_t>(p);
+    auto a_m = allocate_on_hardware<int64_t>({40, 2});
+    to_montgomery<int64_t>(host_to_device<int64_t>(a), p_hw, a_m);
+
+    // Every Montgomery-form result stays in [0, p)
+    auto in_range = [&](const std::shared_ptr<DeviceTensor<int64_t>>& t) {
+        const torch::Tensor v = device_to_host<int64_t>(t);
+        return is_montgomery<int64_t>(t) && torch::all(v >= 0).item<bool>() && torch::all(v < p).item<bool>();
+    };
+    auto result_hw = allocate_on_hardware<int64_t>({40, 2});
+    modmul_tct<int64_t>(a_m, -1, p_hw, result_hw);
+    ASSERT_TRUE(in_range(result_hw));
+    from_montgomery<int64_t>(result_hw, p_hw, result_hw);
+    ASSERT_TRUE(torch::equal(device_to_host<int64_t>(result_hw), torch::remainder(-a, p)));
+
+    modmuladd_ttt<int64_t>(a_m, host_to_device<int64_t>(b), a_m, p_hw, result_hw);
+    ASSERT_TRUE(in_range(result_hw));
+    from_montgomery<int64_t>(result_hw, p_hw, result_hw);
+    ASSERT_TRUE(torch::equal(device_to_host<int64_t>(result_hw), torch::remainder(a * -2, p)));
+
+    // A negative input of to_montgomery
+    to_montgomery<int64_t>(host_to_device<int64_t>(b), p_hw, result_hw);
+    ASSERT_TRUE(in_range(result_hw));
+    from_montgomery<int64_t>(result_hw, p_hw, result_hw);
+    ASSERT_TRUE(torch::equal(device_to_host<int64_t>(result_hw), torch::remainder(b, p)));
+}
+
+TEST(ModMontgomeryTests, MismatchedFormsAndEvenModuliThrow) {
+    auto a_hw = host_to_device<int64_t>(torch::randint(0, 10, {2, 3}, torch::kInt64));
+    auto p_hw = host_to_device<int64_t>(torch::tensor({11, 13, 17}, torch::kInt64));
+    auto a_m = allocate_on_hardware<int64_t>({2, 3});
+    auto result_hw = allocate_on_hardware<int64_t>({2, 3});
+    to_montgomery<int64_t>(a_hw, p_hw, a_m);
+
+    EXPECT_THROW(modsum_ttt<int64_t>(a_m, a_hw, p_hw, result_hw), std::invalid_argument);
+    EXPECT_THROW(mod_tc<int64_t>(a_m, 7, result_hw), std::invalid_argument);
+    EXPECT_THROW(from_montgomery<int64_t>(a_hw, p_hw, result_hw), std::invalid_argument);
+    EXPECT_THROW(to_montgomery<int64_t>(a_m, p_hw, result_hw), std::invalid_argument);
+    auto even_hw = host_to_device<int64_t>(torch::tensor({11, 14, 17}, torch::kInt64));
+    EXPECT_THROW(to_montgomery<int64_t>(a_hw, even_hw, result_hw), std::invalid_argument);
+}
+
+TEST(ModNegTests, MatchesReference) {
+    auto p = torch::tensor({1000003, 65537, 97}, torch::kInt64);
+    auto a = torch::randint(0, 97, {500, 3}, torch::kInt64);
+    a[0][1] = -5;  // out of range: still the residue of -a
+    a[1][2] = 200;
+    auto p_hw = host_to_device<int64_t>(p);
+    auto a_hw = host_to_device<int64_t>(a);
+    auto result_hw = allocate_on_hardware<int64_t>({500, 3});
+
+    modneg_tt<int64_t>(a_hw, p_hw, result_hw);
+    ASSERT_TRUE(torch::equal(device_to_host<int64_t>(result_hw), torch::remainder(-a, p)));
+
+    modneg_tc<int64_t>(a_hw, 97, result_hw);
+    ASSERT_TRUE(torch::equal(device_to_host<int64_t>(result_hw), torch::remainder(-a, 97)));
+
+    // In place, with a broadcast row
+    auto b_hw = host_to_device<int64_t>(a.slice(0, 0, 1));
+    modneg_tt<int64_t>(b_hw, p_hw, result_hw);
+    ASSERT_TRUE(torch::equal(device_to_host<int64_t>(result_hw),
+                             torch::remainder(-a.slice(0, 0, 1), p).expand({500, 3})));
+    modneg_tt<int64_t>(a_hw, p_hw, a_hw);
+    ASSERT_TRUE(torch::equal(device_to_host<int64_t>(a_hw), torch::remainder(-a, p)));
+}
+
+TEST(ModNegTests, KeepsMontgomeryForm) {
+    auto p = torch::tensor({12289, 40961}, torch::kInt32);
+    auto a = torch::randint(0, 12289, {64, 2}, torch::kInt32);
+    auto p_hw = host_to_device<int32_t>(p);
+    auto a_m = allocate_on_hardware<int32_t>({64, 2});
+    to_montgomery<int32_t>(host_to_device<int32_t>(a), p_hw, a_m);
+
+    auto result_hw = allocate_on_hardware<int32_t>({64, 2});
+    modneg_tt<int32_t>(a_m, p_hw, result_hw);
+    ASSERT_TRUE(is_montgomery<int32_t>(result_hw));
+    from_montgomery<int32_t>(result_hw, p_hw, result_hw);
+    ASSERT_TRUE(torch::equal(device_to_host<int32_t>(result_hw), torch::remainder(-a, p)));
+}
@@ -30,3 +30,25 @@ TEST(NonContiguousTests, TransposeAndAddWithStrides) {
 
     ASSERT_TRUE(torch::equal(result, expected)) << "modmul_ttt failed on transpose with noncontiguous strides.";
 }
+
+TEST(NonContiguousTests, PermutedAndBroadcastAcrossThreads) {
+    // Large enough for the elementwise loop to split the work across threads
+    torch::Tensor base = torch::randint(0, 1 << 20, {8, 64, 65}, torch::kInt64);
+    torch::Tensor a = base.permute({1, 2, 0});                                   // [64, 65, 8], non-contiguous
+    torch::Tensor b = torch::randint(0, 1 << 20, {65, 1}, torch::kInt64);        // broadcast over [64, *, 8]
+    torch::Tensor p = torch::tensor({97, 101, 103, 107, 109, 113, 127, 131}, torch::kInt64);
+    ASSERT_FALSE(a.is_contiguous());
+
+    auto a_hw = host_to_device<int64_t>(a);
+    auto b_hw = host_to_device<int64_t>(b);
+    auto p_hw = host_to_device<int64_t>(p);
+    auto result_hw = allocate_on_hardware<int64_t>({64, 65, 8});
+
+    modmul_ttt(a_hw, b_hw, p_hw, result_hw);
+    ASSERT_TRUE(torch::equal(device_to_host<int64_t>(result_hw), (a * b).remainder(p)))
+        << "modmul_ttt failed on a permuted tensor with a broadcast operand.";
+
+    modsum_ttt(a_hw, b_hw, p_hw, result_hw);
+    ASSERT_TRUE(torch::equal(device_to_host<int64_t>(result_hw), (a + b).remainder(p)))
+        << "modsum_ttt failed on a permuted tensor with a broadcast operand.";
+}
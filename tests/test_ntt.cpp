@@ -1,9 +1,131 @@
 #include "gtest/gtest.h"
 #include "lattica_hw_api.h"
 #include <torch/torch.h>
+#include <limits>
+#include <cstdlib>
 
 using namespace lattica_hw_api;
 
+namespace {
+
+int64_t pow_mod(int64_t base, int64_t exp, int64_t mod) {
+    unsigned __int128 result = 1, b = static_cast<uint64_t>(base) % static_cast<uint64_t>(mod);
+    for (; exp > 0; exp >>= 1) {
+        if (exp & 1) result = result * b % static_cast<uint64_t>(mod);
+        b = b * b % static_cast<uint64_t>(mod);
+    }
+    return static_cast<int64_t>(result);
+}
+
+// Primitive 2m-th root of unity modulo an NTT-friendly prime p = 1 mod 2m.
+int64_t find_psi(int64_t p, int64_t m) {
+    for (int64_t g = 2;; ++g) {
+        int64_t psi = pow_mod(g, (p - 1) / (2 * m), p);
+        if (pow_mod(psi, m, p) == p - 1) return psi;
+    }
+}
+
+int64_t bit_reverse(int64_t x, int64_t log_m) {
+    int64_t r = 0;
+    for (int64_t b = 0; b < log_m; ++b) r = (r << 1) | ((x >> b) & 1);
+    return r;
+}
+
+struct NttTables {
+    torch::Tensor p, perm, twiddles, inv_twiddles, m_inv;
+    std::vector<int64_t> psi;
+};
+
+// Negacyclic tables in the layout ntt()/intt() expect: bit-reversed powers of psi
+// and psi^-1 per modulus, and the bit-reversal permutation.
+NttTables make_ntt_tables(const std::vector<int64_t>& primes, int64_t m) {
+    const int64_t k = primes.size();
+    int64_t log_m = 0;
+    while ((int64_t(1) << log_m) < m) ++log_m;
+
+    NttTables tables;
+    tables.p = torch::tensor(primes, torch::kInt64);
+    tables.perm = torch::empty({m}, torch::kInt64);
+    tables.twiddles = torch::empty({k, m}, torch::kInt64);
+    tables.inv_twiddles = torch::empty({k, m}, torch::kInt64);
+    tables.m_inv = torch::empty({k}, torch::kInt64);
+
+    for (int64_t u = 0; u < m; ++u) tables.perm[u] = bit_reverse(u, log_m);
+    for (int64_t t = 0; t < k; ++t) {
+        const int64_t p = primes[t];
+        const int64_t psi = find_psi(p, m);
+        const int64_t psi_inv = pow_mod(psi, p - 2, p);
+        tables.psi.push_back(psi);
+        tables.m_inv[t] = pow_mod(m, p - 2, p);
+        for (int64_t u = 0; u < m; ++u) {
+            tables.twiddles[t][u] = pow_mod(psi, bit_reverse(u, log_m), p);
+            tables.inv_twiddles[t][u] = pow_mod(psi_inv, bit_reverse(u, log_m), p);
+        }
+    }
+    return tables;
+}
+
+// Random residues of shape [l, m, r, k], reduced per modulus along the last axis.
+torch::Tensor random_residues(const std::vector<int64_t>& shape, const torch::Tensor& p) {
+    return torch::randint(0, std::numeric_limits<int64_t>::max(), shape, torch::kInt64).remainder(p);
+}
+
+// Direct negacyclic evaluation: out[u] = sum_x a[x] * psi^((2u + 1) x) mod p.
+torch::Tensor reference_ntt(const torch::Tensor& a, const NttTables& tables) {
+    auto out = torch::zeros_like(a);
+    auto a_acc = a.accessor<int64_t, 4>();
+    auto out_acc = out.accessor<int64_t, 4>();
+    for (int64_t t = 0; t < a.size(3); ++t) {
+        const int64_t p = tables.p[t].item<int64_t>();
+        for (int64_t u = 0; u < a.size(1); ++u) {
+            const int64_t w = pow_mod(tables.psi[t], 2 * u + 1, p);
+            for (int64_t i = 0; i < a.size(0); ++i) {
+                for (int64_t j = 0; j < a.size(2); ++j) {
+                    unsigned __int128 sum = 0, power = 1;
+                    for (int64_t x = 0; x < a.size(1); ++x) {
+                        sum = (sum + power * static_cast<uint64_t>(a_acc[i][x][j][t])) % static_cast<uint64_t>(p);
+                        power = power * static_cast<uint64_t>(w) % static_cast<uint64_t>(p);
+                    }
+                    out_acc[i][u][j][t] = static_cast<int64_t>(sum);
+                }
+            }
+        }
+    }
+    return out;
+}
+
+// Runs ntt() against the direct evaluation and checks that intt() restores the input.
+// The tables and the reference are computed in int64 and converted to T.
+template <typename T = int64_t>
+void check_ntt_roundtrip(const std::vector<int64_t>& primes, int64_t l, int64_t m, int64_t r) {
+    const int64_t k = primes.size();
+    const auto dtype = torch::CppTypeToScalarType<T>();
+    NttTables tables = make_ntt_tables(primes, m);
+    torch::Tensor a_cpu = random_residues({l, m, r, k}, tables.p);
+
+    auto a_hw = host_to_device<T>(a_cpu.to(dtype));
+    auto p_hw = host_to_device<T>(tables.p.to(dtype));
+    auto perm_hw = host_to_device<T>(tables.perm.to(dtype));
+    auto twiddles_hw = host_to_device<T>(tables.twiddles.to(dtype));
+    auto inv_twiddles_hw = host_to_device<T>(tables.inv_twiddles.to(dtype));
+    auto m_inv_hw = host_to_device<T>(tables.m_inv.to(dtype));
+    auto result_hw = allocate_on_hardware<T>({l, m, r, k});
+    auto restored_hw = allocate_on_hardware<T>({l, m, r, k});
+
+    ntt<T>(a_hw, p_hw, perm_hw, twiddles_hw, nullptr, nullptr, result_hw);
+    intt<T>(result_hw, p_hw, perm_hw, inv_twiddles_hw, m_inv_hw, nullptr, nullptr, restored_hw);
+
+    torch::Tensor result_cpu = device_to_host<T>(result_hw).to(torch::kInt64);
+    torch::Tensor restored_cpu = device_to_host<T>(restored_hw).to(torch::kInt64);
+
+    ASSERT_TRUE(torch::equal(result_cpu, reference_ntt(a_cpu, tables)))
+        << "NTT does not match direct evaluation for l=" << l << " m=" << m << " r=" << r << " k=" << k;
+    ASSERT_TRUE(torch::equal(restored_cpu, a_cpu))
+        << "INTT did not restore the input for l=" << l << " m=" << m << " r=" << r << " k=" << k;
+}
+
+} // namespace
+
 TEST(NTTTests, PerformNTTAndVerifyRestorationTorch) {
     // Input tensor a: [1, 4, 1, 2] → l = 1, m = 4, r = 1, k = 2
     torch::Tensor a_cpu = torch::tensor(
@@ -51,3 +173,200 @@ TEST(NTTTests, PerformNTTAndVerifyRestorationTorch) {
         << "Restored input does not match the original input.\n"
         << "Expected:\n" << a_cpu << "\nActual:\n" << restored_cpu;
 }
+
+TEST(NTTTests, BarrettConstantsAreNotRead) {
+    torch::Tensor a_cpu = torch::tensor({{{{1, 2}}, {{3, 4}}, {{5, 6}}, {{7, 8}}}}, torch::dtype(torch::kInt32));
+    torch::Tensor p_cpu = torch::tensor({17, 257}, torch::dtype(torch::kInt32));
+    torch::Tensor perm_cpu = torch::tensor({0, 2, 1, 3}, torch::dtype(torch::kInt32));
+    torch::Tensor twiddles_cpu = torch::tensor({{1, 4, 2, 8}, {1, 16, 4, 64}}, torch::dtype(torch::kInt32));
+    torch::Tensor log2p_cpu = torch::tensor({4, 8}, torch::dtype(torch::kInt32));
+    torch::Tensor bad_mu_cpu = torch::tensor({60, 1000}, torch::dtype(torch::kInt32));  // expected {60, 1020}
+
+    auto a_hw = host_to_device<int32_t>(a_cpu);
+    auto p_hw = host_to_device<int32_t>(p_cpu);
+    auto perm_hw = host_to_device<int32_t>(perm_cpu);
+    auto twiddles_hw = host_to_device<int32_t>(twiddles_cpu);
+    auto log2p_hw = host_to_device<int32_t>(log2p_cpu);
+    auto bad_mu_hw = host_to_device<int32_t>(bad_mu_cpu);
+    auto expected_hw = allocate_on_hardware<int32_t>({1, 4, 1, 2});
+    auto result_hw = allocate_on_hardware<int32_t>({1, 4, 1, 2});
+
+    // Stale or partial constants are accepted, as before the transforms stopped using them
+    ntt<int32_t>(a_hw, p_hw, perm_hw, twiddles_hw, nullptr, nullptr, expected_hw);
+    ntt<int32_t>(a_hw, p_hw, perm_hw, twiddles_hw, log2p_hw, bad_mu_hw, result_hw);
+    ASSERT_TRUE(torch::equal(device_to_host<int32_t>(result_hw), device_to_host<int32_t>(expected_hw)));
+    ntt<int32_t>(a_hw, p_hw, perm_hw, twiddles_hw, log2p_hw, nullptr, result_hw);
+    ASSERT_TRUE(torch::equal(device_to_host<int32_t>(result_hw), device_to_host<int32_t>(expected_hw)));
+}
+
+TEST(NTTTests, ShoupPathOnLargeModuli) {
+    // 60- and 62-bit NTT-friendly primes (= 1 mod 2^17) exercise the lazy [0, 4p) butterflies
+    check_ntt_roundtrip({1152921504606584833LL, 4611686018425815041LL}, 2, 32, 3);
+}
+
+TEST(NTTTests, DivisionPathOnModuliAboveLazyBound) {
+    // p >= 2^62 (int64) and p >= 2^30 (int32) do not fit the [0, 4p) lazy butterflies and
+    // take the division reducer; mixed with a Shoup-path modulus in the same call
+    check_ntt_roundtrip<int64_t>({9223372036844421121LL, 1152921504606584833LL}, 2, 32, 3);
+    check_ntt_roundtrip<int32_t>({2147389441, 12289}, 2, 32, 3);
+}
+
+TEST(NTTTests, SingleBatchManyModuli) {
+    // l * r = 1: all parallelism has to come from the k axis
+    check_ntt_roundtrip({1152921504606584833LL, 1152921504598720513LL,
+                         1152921504597016577LL, 1152921504595968001LL}, 1, 64, 1);
+}
+
+TEST(NTTTests, NonContiguousInputAndOutput) {
+    const int64_t l = 2, m = 16, r = 3;
+    NttTables tables = make_ntt_tables({1152921504606584833LL, 1152921504598720513LL}, m);
+    const int64_t k = tables.p.size(0);
+
+    // Physical layout [l, r, k, m] viewed as [l, m, r, k]: the m axis has unit stride
+    torch::Tensor a_cpu = random_residues({l, r, k, m}, tables.p.unsqueeze(1)).permute({0, 3, 1, 2});
+    torch::Tensor out_cpu = torch::zeros({l, r, k, m}, torch::kInt64).permute({0, 3, 1, 2});
+    ASSERT_FALSE(a_cpu.is_contiguous());
+
+    auto p_hw = host_to_device<int64_t>(tables.p);
+    auto perm_hw = host_to_device<int64_t>(tables.perm);
+    auto twiddles_hw = host_to_device<int64_t>(tables.twiddles);
+    auto inv_twiddles_hw = host_to_device<int64_t>(tables.inv_twiddles);
+    auto m_inv_hw = host_to_device<int64_t>(tables.m_inv);
+
+    auto a_hw = host_to_device<int64_t>(a_cpu);
+    auto result_hw = host_to_device<int64_t>(out_cpu);
+    auto restored_hw = host_to_device<int64_t>(out_cpu);
+    auto expected_hw = allocate_on_hardware<int64_t>({l, m, r, k});
+
+    ntt<int64_t>(host_to_device<int64_t>(a_cpu.contiguous()), p_hw, perm_hw, twiddles_hw, nullptr, nullptr, expected_hw);
+    ntt<int64_t>(a_hw, p_hw, perm_hw, twiddles_hw, nullptr, nullptr, result_hw);
+    intt<int64_t>(result_hw, p_hw, perm_hw, inv_twiddles_hw, m_inv_hw, nullptr, nullptr, restored_hw);
+
+    ASSERT_TRUE(torch::equal(device_to_host<int64_t>(result_hw), device_to_host<int64_t>(expected_hw)))
+        << "NTT on strided input/output does not match the contiguous result.";
+    ASSERT_TRUE(torch::equal(device_to_host<int64_t>(restored_hw), a_cpu))
+        << "INTT on strided input/output did not restore the input.";
+}
+
+// r * k = 9 columns leave a scalar tail for every vector width; LATTICA_SIMD forces each
+// level (it is capped at what the CPU supports, so unsupported levels rerun a lower one).
+TEST(NTTTests, RaggedLimbCountOnEveryVectorLevel) {
+    const std::vector<int64_t> primes = {1152921504606584833LL, 1152921504598720513LL, 1152921504597016577LL};
+    for (const char* level : {"scalar", "avx2", "avx512"}) {
+        SCOPED_TRACE(level);
+        setenv("LATTICA_SIMD", level, 1);
+        check_ntt_roundtrip(primes, 2, 32, 3);
+    }
+    unsetenv("LATTICA_SIMD");
+}
+
+// Stages run as radix-4 pairs; odd log2(m) leaves a radix-2 stage on every level.
+TEST(NTTTests, RadixFourWithRadixTwoTail) {
+    for (const char* level : {"scalar", "avx2", "avx512"}) {
+        SCOPED_TRACE(level);
+        setenv("LATTICA_SIMD", level, 1);
+        for (int64_t m = 2; m <= 256; m *= 2)
+            check_ntt_roundtrip({1152921504606584833LL, 1152921504598720513LL}, 1, m, 4);
+    }
+    unsetenv("LATTICA_SIMD");
+}
+
+// The four-step order only reorders the radix-2 butterflies, so forcing it on small
+// transforms (odd and even log2(m)) must reproduce the default results exactly.
+TEST(NTTTests, FourStepMatchesRadix2) {
+    const int64_t saved = get_ntt_four_step_threshold();
+    for (int64_t m : {64, 128}) {
+        NttTables tables = make_ntt_tables({1152921504606584833LL, 1152921504598720513LL}, m);
+        const int64_t l = 2, r = 3, k = tables.p.size(0);
+        torch::Tensor a_cpu = random_residues({l, m, r, k}, tables.p);
+
+        auto a_hw = host_to_device<int64_t>(a_cpu);
+        auto p_hw = host_to_device<int64_t>(tables.p);
+        auto perm_hw = host_to_device<int64_t>(tables.perm);
+        auto twiddles_hw = host_to_device<int64_t>(tables.twiddles);
+        auto inv_twiddles_hw = host_to_device<int64_t>(tables.inv_twiddles);
+        auto m_inv_hw = host_to_device<int64_t>(tables.m_inv);
+        auto radix2_hw = allocate_on_hardware<int64_t>({l, m, r, k});
+        auto blocked_hw = allocate_on_hardware<int64_t>({l, m, r, k});
+        auto restored_hw = allocate_on_hardware<int64_t>({l, m, r, k});
+
+        set_ntt_four_step_threshold(0);
+        ntt<int64_t>(a_hw, p_hw, perm_hw, twiddles_hw, nullptr, nullptr, radix2_hw);
+        set_ntt_four_step_threshold(4);
+        ntt<int64_t>(a_hw, p_hw, perm_hw, twiddles_hw, nullptr, nullptr, blocked_hw);
+        intt<int64_t>(blocked_hw, p_hw, perm_hw, inv_twiddles_hw, m_inv_hw, nullptr, nullptr, restored_hw);
+
+        EXPECT_TRUE(torch::equal(device_to_host<int64_t>(blocked_hw), device_to_host<int64_t>(radix2_hw)))
+            << "Four-step NTT differs from radix-2 for m=" << m;
+        EXPECT_TRUE(torch::equal(device_to_host<int64_t>(restored_hw), a_cpu))
+            << "Four-step INTT did not restore the input for m=" << m;
+    }
+    set_ntt_four_step_threshold(saved);
+}
+
+// skip_perm leaves the spectrum in butterfly order: row perm[u] of the skipped result is
+// row u of the regular one, and intt(skip_perm) undoes it without a permutation tensor.
+TEST(NTTTests, SkipPermKeepsBitReversedOrder) {
+    const int64_t l = 2, m = 32, r = 3;
+    NttTables tables = make_ntt_tables({1152921504606584833LL, 1152921504598720513LL, 1152921504597016577LL}, m);
+    const int64_t k = tables.p.size(0);
+    torch::Tensor a_cpu = random_residues({l, m, r, k}, tables.p);
+
+    auto a_hw = host_to_device<int64_t>(a_cpu);
+    auto p_hw = host_to_device<int64_t>(tables.p);
+    auto perm_hw = host_to_device<int64_t>(tables.perm);
+    auto twiddles_hw = host_to_device<int64_t>(tables.twiddles);
+    auto inv_twiddles_hw = host_to_device<int64_t>(tables.inv_twiddles);
+    auto m_inv_hw = host_to_device<int64_t>(tables.m_inv);
+    auto natural_hw = allocate_on_hardware<int64_t>({l, m, r, k});
+    auto bitrev_hw = allocate_on_hardware<int64_t>({l, m, r, k});
+    auto restored_hw = allocate_on_hardware<int64_t>({l, m, r, k});
+
+    ntt<int64_t>(a_hw, p_hw, perm_hw, twiddles_hw, nullptr, nullptr, natural_hw);
+    ntt<int64_t>(a_hw, p_hw, nullptr, twiddles_hw, nullptr, nullptr, bitrev_hw, /*skip_perm=*/true);
+    intt<int64_t>(bitrev_hw, p_hw, nullptr, inv_twiddles_hw, m_inv_hw, nullptr, nullptr, restored_hw, /*skip_perm=*/true);
+
+    torch::Tensor natural = device_to_host<int64_t>(natural_hw);
+    torch::Tensor bitrev = device_to_host<int64_t>(bitrev_hw);
+    ASSERT_TRUE(torch::equal(bitrev.index_select(1, tables.perm), natural))
+        << "ntt(skip_perm) is not the bit-reversed ntt() result.";
+    ASSERT_TRUE(torch::equal(device_to_host<int64_t>(restored_hw), a_cpu))
+        << "intt(skip_perm) did not restore the input.";
+}
+
+TEST(NTTTests, PlanMatchesTensorEntryPoints) {
+    const int64_t l = 2, m = 64, r = 3;
+    NttTables tables = make_ntt_tables({1152921504606584833LL, 1152921504598720513LL, 1152921504597016577LL}, m);
+    const int64_t k = tables.p.size(0);
+    torch::Tensor a_cpu = random_residues({l, m, r, k}, tables.p);
+
+    auto a_hw = host_to_device<int64_t>(a_cpu);
+    auto p_hw = host_to_device<int64_t>(tables.p);
+    auto perm_hw = host_to_device<int64_t>(tables.perm);
+    auto twiddles_hw = host_to_device<int64_t>(tables.twiddles);
+    auto inv_twiddles_hw = host_to_device<int64_t>(tables.inv_twiddles);
+    auto m_inv_hw = host_to_device<int64_t>(tables.m_inv);
+    auto expected_hw = allocate_on_hardware<int64_t>({l, m, r, k});
+    auto result_hw = allocate_on_hardware<int64_t>({l, m, r, k});
+    auto restored_hw = allocate_on_hardware<int64_t>({l, m, r, k});
+
+    const NttPlan<int64_t> plan(p_hw, perm_hw, twiddles_hw, inv_twiddles_hw, m_inv_hw);
+    EXPECT_EQ(plan.m(), m);
+    EXPECT_EQ(plan.k(), k);
+
+    ntt<int64_t>(a_hw, p_hw, perm_hw, twiddles_hw, nullptr, nullptr, expected_hw);
+    ntt<int64_t>(a_hw, plan, result_hw);
+    intt<int64_t>(result_hw, plan, restored_hw);
+
+    ASSERT_TRUE(torch::equal(device_to_host<int64_t>(result_hw), device_to_host<int64_t>(expected_hw)))
+        << "Plan-based NTT does not match the tensor entry point.";
+    ASSERT_TRUE(torch::equal(device_to_host<int64_t>(restored_hw), a_cpu))
+        << "Plan-based INTT did not restore the input.";
+
+    // A forward-only plan without perm serves skip_perm transforms and rejects the rest
+    const NttPlan<int64_t> forward(p_hw, nullptr, twiddles_hw, nullptr, nullptr);
+    ntt<int64_t>(a_hw, forward, result_hw, /*skip_perm=*/true);
+    EXPECT_THROW(ntt<int64_t>(a_hw, forward, result_hw), std::invalid_argument);
+    EXPECT_THROW(intt<int64_t>(a_hw, forward, result_hw, /*skip_perm=*/true), std::invalid_argument);
+    EXPECT_THROW(NttPlan<int64_t>(p_hw, perm_hw, nullptr, inv_twiddles_hw, nullptr), std::invalid_argument);
+}